@@ -1,6 +1,6 @@
 #!/usr/bin/env bash
 # build.sh — build and flash for STM32WLE5JC (single target).
-# Usage: ./build.sh <build|flash|clean>
+# Usage: ./build.sh <build|flash|test|clean>
 
 set -e
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
@@ -14,6 +14,7 @@ usage() {
   echo "Commands:"
   echo "  build   Configure and build (STM32WLE5JC)."
   echo "  flash   Flash meshtastic_mini.elf to the device (openocd or st-flash)."
+  echo "  test    Build and run the host tests (tests/, native compiler)."
   echo "  clean   Remove build directory."
   exit 1
 }
@@ -50,6 +51,13 @@ cmd_flash() {
   echo "Flash done."
 }
 
+cmd_test() {
+  HOST_BUILD_DIR="${HOST_BUILD_DIR:-build-host}"
+  cmake -S tests -B "$HOST_BUILD_DIR"
+  cmake --build "$HOST_BUILD_DIR"
+  ctest --test-dir "$HOST_BUILD_DIR" --output-on-failure
+}
+
 cmd_clean() {
   if [ -d "$BUILD_DIR" ]; then
     rm -rf "$BUILD_DIR"
@@ -61,6 +69,7 @@ cmd_clean() {
 case "${1:-build}" in
   build)  cmd_build ;;
   flash)  cmd_flash ;;
+  test)   cmd_test ;;
   clean)  cmd_clean ;;
   -h|--help) usage ;;
   *)
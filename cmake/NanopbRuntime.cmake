@@ -1,6 +1,8 @@
-# Include nanopb runtime from submodule third_party/nanopb (no generator).
+# nanopb runtime and generator from submodule third_party/nanopb.
 # Call from project root: include(cmake/NanopbRuntime.cmake)
 # Requires: git submodule update --init --recursive
+# The generator needs Python 3 with the protobuf package and protoc
+# (or grpcio-tools): pip install protobuf grpcio-tools
 
 set(NANOPB_ROOT ${CMAKE_SOURCE_DIR}/third_party/nanopb)
 if(NOT EXISTS ${NANOPB_ROOT}/pb.h)
@@ -13,3 +15,39 @@ set(NANOPB_RUNTIME_SRCS
   ${NANOPB_ROOT}/pb_decode.c
 )
 set(NANOPB_INCLUDE_DIR ${NANOPB_ROOT})
+
+find_package(Python3 COMPONENTS Interpreter REQUIRED)
+set(NANOPB_GENERATOR ${NANOPB_ROOT}/generator/nanopb_generator.py)
+set(NANOPB_GENERATED_DIR ${CMAKE_BINARY_DIR}/nanopb)
+
+# nanopb_generate(<out_srcs_var> <proto_root> <proto>...)
+# Runs the generator on each <proto> (a path relative to <proto_root>; its
+# .options file is picked up from the same place) at build time. Output goes
+# to ${NANOPB_GENERATED_DIR}/<same relative path>.pb.{c,h}; add that
+# directory to the include path. The .pb.c files are returned in
+# <out_srcs_var>.
+function(nanopb_generate out_srcs proto_root)
+  set(srcs)
+  foreach(proto ${ARGN})
+    get_filename_component(rel_dir ${proto} DIRECTORY)
+    get_filename_component(name ${proto} NAME_WE)
+    set(gen_c ${NANOPB_GENERATED_DIR}/${rel_dir}/${name}.pb.c)
+    set(gen_h ${NANOPB_GENERATED_DIR}/${rel_dir}/${name}.pb.h)
+    set(deps ${proto_root}/${proto} ${NANOPB_GENERATOR})
+    if(EXISTS ${proto_root}/${rel_dir}/${name}.options)
+      list(APPEND deps ${proto_root}/${rel_dir}/${name}.options)
+    endif()
+    add_custom_command(
+      OUTPUT ${gen_c} ${gen_h}
+      COMMAND ${CMAKE_COMMAND} -E make_directory ${NANOPB_GENERATED_DIR}
+      COMMAND ${Python3_EXECUTABLE} ${NANOPB_GENERATOR}
+              -I ${proto_root} -D ${NANOPB_GENERATED_DIR} ${proto}
+      WORKING_DIRECTORY ${proto_root}
+      DEPENDS ${deps}
+      COMMENT "nanopb: generating ${proto}"
+      VERBATIM
+    )
+    list(APPEND srcs ${gen_c})
+  endforeach()
+  set(${out_srcs} ${srcs} PARENT_SCOPE)
+endfunction()
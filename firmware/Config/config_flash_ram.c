@@ -0,0 +1,55 @@
+/**
+ * RAM flash emulator for config_log (host builds).
+ */
+
+#include "config_flash_ram.h"
+#include <string.h>
+
+static bool ram_read(void *ctx, uint32_t addr, void *buf, uint16_t len) {
+    config_flash_ram_t *r = (config_flash_ram_t *)ctx;
+    if (addr > r->size || len > r->size - addr) return false;
+    memcpy(buf, r->mem + addr, len);
+    return true;
+}
+
+static bool ram_program(void *ctx, uint32_t addr, const void *data, uint16_t len) {
+    config_flash_ram_t *r = (config_flash_ram_t *)ctx;
+    if ((addr & 7u) || (len & 7u) || addr > r->size || len > r->size - addr) return false;
+    const uint8_t *src = (const uint8_t *)data;
+    for (uint16_t i = 0; i < len; i += 8) {
+        uint8_t *dst = r->mem + addr + i;
+        for (uint8_t k = 0; k < 8; k++)
+            if (dst[k] != 0xFF) return false;       /* PROGERR: not erased */
+        if (r->cut_after == 0) return false;
+        if (r->cut_after > 0) r->cut_after--;
+        memcpy(dst, src + i, 8);
+        r->programs++;
+    }
+    return true;
+}
+
+static bool ram_erase(void *ctx, uint32_t addr) {
+    config_flash_ram_t *r = (config_flash_ram_t *)ctx;
+    if (addr >= r->size) return false;
+    if (r->cut_after == 0) return false;
+    memset(r->mem + (addr - addr % r->page_size), 0xFF, r->page_size);
+    r->erases++;
+    return true;
+}
+
+void config_flash_ram_init(config_flash_t *flash, config_flash_ram_t *ram, uint8_t *mem,
+                           uint16_t page_size, uint8_t page_count) {
+    memset(ram, 0, sizeof(*ram));
+    ram->mem = mem;
+    ram->page_size = page_size;
+    ram->size = (uint32_t)page_size * page_count;
+    ram->cut_after = -1;
+    memset(mem, 0x00, ram->size);
+    flash->ctx = ram;
+    flash->base = 0;
+    flash->page_size = page_size;
+    flash->page_count = page_count;
+    flash->read = ram_read;
+    flash->program = ram_program;
+    flash->erase = ram_erase;
+}
@@ -0,0 +1,33 @@
+/**
+ * RAM-backed flash for config_log on a host: same rules as the STM32WL
+ * (erase sets 0xFF, each doubleword programmed once, 8-byte aligned), plus
+ * an injected power cut after a number of programmed doublewords.
+ */
+
+#ifndef CONFIG_FLASH_RAM_H
+#define CONFIG_FLASH_RAM_H
+
+#include "config_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t  *mem;          /* page_size * page_count bytes */
+    uint32_t  size;
+    uint16_t  page_size;
+    uint32_t  erases;
+    uint32_t  programs;     /* doublewords */
+    int32_t   cut_after;    /* doublewords left before power "fails"; < 0 = never */
+} config_flash_ram_t;
+
+/* Set up flash (base 0) over mem and mark every page as never erased (0x00). */
+void config_flash_ram_init(config_flash_t *flash, config_flash_ram_t *ram, uint8_t *mem,
+                           uint16_t page_size, uint8_t page_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_FLASH_RAM_H */
@@ -0,0 +1,215 @@
+/**
+ * Config record log. Page layout:
+ *   [page header: magic u32, generation u32]
+ *   [record: magic u16, len u16, seq u32 | payload | crc32 u32 | 0xFF pad to 8]...
+ * The CRC covers record header + payload and is programmed last; a record
+ * without a valid CRC (torn write) is skipped. The newest page is the one
+ * with the highest generation.
+ */
+
+#include "config_log.h"
+#include <string.h>
+
+#define PAGE_MAGIC   0x474C434DU    /* "MCLG" */
+#define REC_MAGIC    0x5243U        /* "CR" */
+#define PAGE_HDR     8u
+#define REC_HDR      8u
+#define REC_CRC      4u
+#define NO_PAGE      0xFF
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+} page_hdr_t;
+
+typedef struct {
+    uint16_t magic;
+    uint16_t len;
+    uint32_t seq;
+} rec_hdr_t;
+
+/* CRC-32 (IEEE 802.3, reflected), bitwise: records are small and rare */
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, uint16_t n) {
+    crc = ~crc;
+    while (n--) {
+        crc ^= *p++;
+        for (uint8_t k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+    }
+    return ~crc;
+}
+
+/* Wrap-safe "a is newer than b" */
+static bool seq_after(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) > 0;
+}
+
+static uint16_t rec_size(uint16_t len) {
+    return (uint16_t)((REC_HDR + len + REC_CRC + 7u) & ~7u);
+}
+
+static uint32_t page_addr(const config_flash_t *fl, uint8_t page) {
+    return fl->base + (uint32_t)page * fl->page_size;
+}
+
+uint16_t config_log_max_record(const config_flash_t *flash) {
+    return (uint16_t)(flash->page_size - PAGE_HDR - REC_HDR - REC_CRC);
+}
+
+/* CRC check reads the record back in small chunks (no page-sized buffer) */
+static bool record_valid(const config_flash_t *fl, uint32_t addr, const rec_hdr_t *h) {
+    uint8_t chunk[32];
+    uint32_t crc = crc32_update(0, (const uint8_t *)h, sizeof(*h));
+    uint32_t p = addr + REC_HDR;
+    uint16_t left = h->len;
+    while (left) {
+        uint16_t n = left < sizeof(chunk) ? left : (uint16_t)sizeof(chunk);
+        if (!fl->read(fl->ctx, p, chunk, n)) return false;
+        crc = crc32_update(crc, chunk, n);
+        p += n;
+        left = (uint16_t)(left - n);
+    }
+    uint32_t stored;
+    if (!fl->read(fl->ctx, p, &stored, sizeof(stored))) return false;
+    return stored == crc;
+}
+
+/* Walk one page's records: newest valid one into log->latest, first free
+ * offset into *tail. Anything unreadable ends the page (no further appends). */
+static bool scan_page(config_log_t *log, uint8_t page, uint16_t *tail) {
+    const config_flash_t *fl = log->flash;
+    uint32_t base = page_addr(fl, page);
+    uint16_t off = PAGE_HDR;
+    while (off + REC_HDR <= fl->page_size) {
+        rec_hdr_t h;
+        if (!fl->read(fl->ctx, base + off, &h, sizeof(h))) return false;
+        if (h.magic == 0xFFFF && h.len == 0xFFFF && h.seq == 0xFFFFFFFFU) break;    /* erased */
+        if (h.magic != REC_MAGIC || rec_size(h.len) > fl->page_size - off) {
+            off = fl->page_size;
+            break;
+        }
+        if (record_valid(fl, base + off, &h) &&
+            (log->latest_len == 0 || seq_after(h.seq, log->seq))) {
+            log->latest = base + off + REC_HDR;
+            log->latest_len = h.len;
+            log->seq = h.seq;
+        }
+        off = (uint16_t)(off + rec_size(h.len));
+    }
+    *tail = off;
+    return true;
+}
+
+/* Generation of a page; false if it has no page header (erased or foreign) */
+static bool page_gen(const config_flash_t *fl, uint8_t page, bool *ok, uint32_t *gen) {
+    page_hdr_t h;
+    if (!fl->read(fl->ctx, page_addr(fl, page), &h, sizeof(h))) {
+        *ok = false;
+        return false;
+    }
+    *gen = h.seq;
+    return h.magic == PAGE_MAGIC && h.seq != 0xFFFFFFFFU;
+}
+
+/* Newest page older than generation `below` (any page if !bounded) */
+static uint8_t newest_page(const config_flash_t *fl, bool bounded, uint32_t below,
+                           bool *ok, uint32_t *gen_out) {
+    uint8_t best = NO_PAGE;
+    for (uint8_t p = 0; p < fl->page_count; p++) {
+        uint32_t gen;
+        if (!page_gen(fl, p, ok, &gen)) continue;
+        if (bounded && !seq_after(below, gen)) continue;
+        if (best == NO_PAGE || seq_after(gen, *gen_out)) {
+            best = p;
+            *gen_out = gen;
+        }
+    }
+    return best;
+}
+
+bool config_log_mount(config_log_t *log, const config_flash_t *flash) {
+    memset(log, 0, sizeof(*log));
+    log->flash = flash;
+    log->page = NO_PAGE;
+
+    bool ok = true;
+    uint32_t gen = 0;
+    uint8_t page = newest_page(flash, false, 0, &ok, &gen);
+    if (!ok) return false;
+    if (page == NO_PAGE) return true;
+
+    log->page = page;
+    log->page_seq = gen;
+    if (!scan_page(log, page, &log->tail)) return false;
+
+    /* Saves cut short after a page was started leave it without a valid
+     * record: the latest config is then in an older page. */
+    while (log->latest_len == 0) {
+        page = newest_page(flash, true, gen, &ok, &gen);
+        if (!ok) return false;
+        if (page == NO_PAGE) break;
+        uint16_t unused;
+        if (!scan_page(log, page, &unused)) return false;
+    }
+    return true;
+}
+
+uint16_t config_log_read(const config_log_t *log, void *buf, uint16_t max) {
+    if (!log->flash || log->latest_len == 0 || log->latest_len > max) return 0;
+    if (!log->flash->read(log->flash->ctx, log->latest, buf, log->latest_len)) return 0;
+    return log->latest_len;
+}
+
+/* Erase the next page round-robin and give it the next generation. The page
+ * holding the only valid record is never chosen. */
+static bool start_page(config_log_t *log) {
+    const config_flash_t *fl = log->flash;
+    uint8_t next = (log->page == NO_PAGE) ? 0 : (uint8_t)((log->page + 1) % fl->page_count);
+    if (log->latest_len && (log->latest - fl->base) / fl->page_size == next)
+        next = log->page;
+    uint32_t addr = page_addr(fl, next);
+    log->erases++;
+    if (!fl->erase(fl->ctx, addr)) return false;
+    page_hdr_t h = { PAGE_MAGIC, log->page_seq + 1 };
+    log->page = next;
+    log->page_seq = h.seq;
+    log->tail = fl->page_size;      /* unusable unless the header lands */
+    if (!fl->program(fl->ctx, addr, &h, sizeof(h))) return false;
+    log->tail = PAGE_HDR;
+    return true;
+}
+
+bool config_log_append(config_log_t *log, const void *data, uint16_t len) {
+    const config_flash_t *fl = log->flash;
+    if (!fl || !data || len == 0 || len > config_log_max_record(fl)) return false;
+    uint16_t need = rec_size(len);
+    if (log->page == NO_PAGE || log->tail + need > fl->page_size) {
+        if (!start_page(log)) return false;
+    }
+
+    uint32_t addr = page_addr(fl, log->page) + log->tail;
+    rec_hdr_t h = { REC_MAGIC, len, log->seq + 1 };
+    uint32_t crc = crc32_update(0, (const uint8_t *)&h, sizeof(h));
+    crc = crc32_update(crc, (const uint8_t *)data, len);
+
+    /* The space is spent even if programming fails part-way */
+    log->tail = (uint16_t)(log->tail + need);
+
+    /* Header, whole doublewords of payload, then the rest + CRC */
+    uint16_t body = (uint16_t)(len & ~7u);
+    uint16_t rest = (uint16_t)(len - body);
+    uint8_t last[16];
+    memset(last, 0xFF, sizeof(last));
+    memcpy(last, (const uint8_t *)data + body, rest);
+    memcpy(last + rest, &crc, sizeof(crc));
+
+    if (!fl->program(fl->ctx, addr, &h, sizeof(h))) return false;
+    if (body && !fl->program(fl->ctx, addr + REC_HDR, data, body)) return false;
+    if (!fl->program(fl->ctx, addr + REC_HDR + body, last, (uint16_t)((rest + REC_CRC + 7u) & ~7u)))
+        return false;
+
+    log->latest = addr + REC_HDR;
+    log->latest_len = len;
+    log->seq = h.seq;
+    return true;
+}
@@ -0,0 +1,66 @@
+/**
+ * Append-only record log over a few flash pages (config_store backend).
+ * A save programs one record behind the last one; a page is erased only when
+ * the active one is full, and pages are used round-robin, so erases are rare
+ * and spread out. The previous record stays intact until a newer one is
+ * complete (CRC written last), so power loss during a save keeps the old
+ * config. Mount reads the page headers and scans only the newest page (an
+ * older one only if the newest holds no complete record); after that the
+ * latest record and the write position are cached.
+ *
+ * Flash access goes through config_flash_t: the STM32WL pages in
+ * config_store.c, or the RAM emulator (config_flash_ram.h) on a host.
+ */
+
+#ifndef CONFIG_LOG_H
+#define CONFIG_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* NOR flash with doubleword programming: erased = 0xFF, each 8-byte unit
+ * programmed once between erases. Addresses are the backend's own. */
+typedef struct {
+    void    *ctx;
+    uint32_t base;          /* address of the first log page */
+    uint16_t page_size;     /* multiple of 8 */
+    uint8_t  page_count;    /* >= 2 */
+    bool (*read)(void *ctx, uint32_t addr, void *buf, uint16_t len);
+    bool (*program)(void *ctx, uint32_t addr, const void *data, uint16_t len); /* len % 8 == 0 */
+    bool (*erase)(void *ctx, uint32_t addr);                                  /* page at addr */
+} config_flash_t;
+
+typedef struct {
+    const config_flash_t *flash;
+    uint8_t  page;          /* active page; 0xFF = log empty */
+    uint32_t page_seq;      /* generation of the active page */
+    uint16_t tail;          /* first free offset in the active page */
+    uint32_t seq;           /* sequence number of the latest record */
+    uint32_t latest;        /* address of its payload; 0 with latest_len 0 = none */
+    uint16_t latest_len;
+    uint32_t erases;        /* page erases since mount */
+} config_log_t;
+
+/* Find the newest page and the latest valid record. False only on a read
+ * error; an empty or foreign log mounts as empty. */
+bool config_log_mount(config_log_t *log, const config_flash_t *flash);
+
+/* Copy the latest record; returns its length (0 = none). Records longer
+ * than max are not copied and return 0. */
+uint16_t config_log_read(const config_log_t *log, void *buf, uint16_t max);
+
+/* Append a record; it becomes the latest once fully written. */
+bool config_log_append(config_log_t *log, const void *data, uint16_t len);
+
+/* Largest record that fits a page. */
+uint16_t config_log_max_record(const config_flash_t *flash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_LOG_H */
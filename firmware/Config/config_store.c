@@ -1,32 +1,109 @@
 /**
- * Config storage in last flash page (STM32WLE5: 256KB Flash, page 127 = 0x0803F800).
- * Layout: magic (4 bytes) + device_config_t. Load/save on boot and on set_config.
+ * Config storage in the last CONFIG_LOG_PAGES flash pages (STM32WLE5: 256KB
+ * Flash, 2KB pages; default pages 124-127 = 0x0803E000), as an append-only
+ * record log (config_log.c): each save adds one CRC-checked device_config_t
+ * record, a page is erased only when the active one fills.
  */
 #include "config_store.h"
+#include <stddef.h>
 #include <string.h>
 
 #if defined(USE_HAL_DRIVER) && defined(HAL_FLASH_MODULE_ENABLED)
 #include "stm32wlxx_hal.h"
 #include "stm32wlxx_hal_flash.h"
 #include "stm32wlxx_hal_flash_ex.h"
+#include "config_log.h"
 
-#define CONFIG_MAGIC        0x4D434647U  /* "MCFG" */
-#define CONFIG_FLASH_PAGE   127
-#define CONFIG_FLASH_ADDR   (FLASH_BASE + (CONFIG_FLASH_PAGE * FLASH_PAGE_SIZE))
+/* Must match the flash reserved at the end of the linker script */
+#ifndef CONFIG_LOG_PAGES
+#define CONFIG_LOG_PAGES     4
+#endif
+#define CONFIG_FLASH_PAGES   128            /* 256KB / 2KB */
+#define CONFIG_LOG_FIRST     (CONFIG_FLASH_PAGES - CONFIG_LOG_PAGES)
+
+/* Single-page store used before the log: magic + device_config_t in page 127 */
+#define CONFIG_LEGACY_MAGIC  0x3246434DU    /* "MCF2" */
+#define CONFIG_LEGACY_ADDR   (FLASH_BASE + ((CONFIG_FLASH_PAGES - 1) * FLASH_PAGE_SIZE))
+
+static bool flash_read(void *ctx, uint32_t addr, void *buf, uint16_t len) {
+    (void)ctx;
+    memcpy(buf, (const void *)addr, len);
+    return true;
+}
+
+static bool flash_program(void *ctx, uint32_t addr, const void *data, uint16_t len) {
+    (void)ctx;
+    const uint8_t *src = (const uint8_t *)data;
+    bool ok = (HAL_FLASH_Unlock() == HAL_OK);
+    for (uint16_t i = 0; ok && i < len; i += 8) {
+        uint64_t dw;
+        memcpy(&dw, src + i, 8);
+        ok = (HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, addr + i, dw) == HAL_OK);
+    }
+    HAL_FLASH_Lock();
+    return ok;
+}
+
+static bool flash_erase(void *ctx, uint32_t addr) {
+    (void)ctx;
+    FLASH_EraseInitTypeDef erase = {
+        .TypeErase = FLASH_TYPEERASE_PAGES,
+        .Page      = (addr - FLASH_BASE) / FLASH_PAGE_SIZE,
+        .NbPages   = 1,
+    };
+    uint32_t page_err = 0;
+    if (HAL_FLASH_Unlock() != HAL_OK)
+        return false;
+    bool ok = (HAL_FLASHEx_Erase(&erase, &page_err) == HAL_OK);
+    HAL_FLASH_Lock();
+    return ok;
+}
+
+static const config_flash_t config_flash = {
+    .ctx        = NULL,
+    .base       = FLASH_BASE + CONFIG_LOG_FIRST * FLASH_PAGE_SIZE,
+    .page_size  = FLASH_PAGE_SIZE,
+    .page_count = CONFIG_LOG_PAGES,
+    .read       = flash_read,
+    .program    = flash_program,
+    .erase      = flash_erase,
+};
+
+static config_log_t config_log;
+static bool config_log_ready;
+
+static bool config_mount(void) {
+    if (!config_log_ready)
+        config_log_ready = config_log_mount(&config_log, &config_flash);
+    return config_log_ready;
+}
+
+static bool config_valid(const device_config_t *cfg) {
+    return cfg->channel_count != 0 && cfg->channel_count <= CONFIG_MAX_CHANNELS;
+}
 
+/* Fields before radio_boot: all that records from older builds carry */
+#define CONFIG_MIN_RECORD    offsetof(device_config_t, radio_boot)
+
+/* cfg holds defaults on entry; a short record leaves the newer fields as is */
 static bool config_from_flash(device_config_t *cfg) {
-    const uint32_t *p = (const uint32_t *)CONFIG_FLASH_ADDR;
-    if (p[0] != CONFIG_MAGIC)
+    uint16_t n = config_mount() ? config_log_read(&config_log, cfg, sizeof(*cfg)) : 0;
+    if (n >= CONFIG_MIN_RECORD && config_valid(cfg))
+        return true;
+    /* Not saved since the log was introduced: take the old page as is */
+    const uint32_t *p = (const uint32_t *)CONFIG_LEGACY_ADDR;
+    if (p[0] != CONFIG_LEGACY_MAGIC)
         return false;
-    memcpy(cfg, p + 1, sizeof(device_config_t));
-    return true;
+    memcpy(cfg, p + 1, CONFIG_MIN_RECORD);
+    return config_valid(cfg);
 }
 #endif
 
-/* Meshtastic default PSK for primary channel "LongFast" (AES-128) */
+/* Meshtastic default PSK for primary channel "LongFast" (AES-128);
+ * channel hash of ("LongFast", this key) = 8, as sent by stock nodes */
 static const uint8_t meshtastic_default_psk[16] = {
-    0xd4, 0xf1, 0xbb, 0x3a, 0x20, 0x29, 0x05, 0x13,
-    0xf0, 0x08, 0x8a, 0xa3, 0x5a, 0xd3, 0x4a, 0x1c
+    0xd4, 0xf1, 0xbb, 0x3a, 0x20, 0x29, 0x07, 0x59,
+    0xf0, 0xbc, 0xff, 0xab, 0xcf, 0x4e, 0x69, 0x01
 };
 
 void config_set_defaults(device_config_t *cfg) {
@@ -35,12 +112,16 @@ void config_set_defaults(device_config_t *cfg) {
     cfg->node_id = 1;
     cfg->region = 0;           /* REGION_EU_868 */
     cfg->modem_preset = 4;     /* MODEM_LONG_FAST */
-    memcpy(cfg->channel_psk, meshtastic_default_psk, 16);
+    cfg->channel_count = 1;
+    strcpy(cfg->channels[0].name, "LongFast");
+    memcpy(cfg->channels[0].psk, meshtastic_default_psk, 16);
+    cfg->channels[0].psk_len = 16;
 }
 
 bool config_load(device_config_t *cfg) {
     if (!cfg) return false;
 #if defined(USE_HAL_DRIVER) && defined(HAL_FLASH_MODULE_ENABLED)
+    config_set_defaults(cfg);
     if (config_from_flash(cfg))
         return true;
 #endif
@@ -51,39 +132,10 @@ bool config_load(device_config_t *cfg) {
 bool config_save(const device_config_t *cfg) {
     if (!cfg) return false;
 #if defined(USE_HAL_DRIVER) && defined(HAL_FLASH_MODULE_ENABLED)
-    FLASH_EraseInitTypeDef erase = {
-        .TypeErase = FLASH_TYPEERASE_PAGES,
-        .Page      = CONFIG_FLASH_PAGE,
-        .NbPages   = 1,
-    };
-    uint32_t page_err = 0;
-
-    if (HAL_FLASH_Unlock() != HAL_OK)
-        return false;
-
-    if (HAL_FLASHEx_Erase(&erase, &page_err) != HAL_OK) {
-        HAL_FLASH_Lock();
+    if (!config_mount())
         return false;
-    }
-
-    /* Program magic + config as doublewords (8 bytes). */
-    uint32_t magic = CONFIG_MAGIC;
-    uint8_t buf[4 + sizeof(device_config_t)];
-    memcpy(buf, &magic, 4);
-    memcpy(buf + 4, cfg, sizeof(device_config_t));
-
-    const uint64_t *src = (const uint64_t *)buf;
-    size_t n_dw = (4 + sizeof(device_config_t) + 7) / 8;
-    uint32_t addr = CONFIG_FLASH_ADDR;
-
-    for (size_t i = 0; i < n_dw; i++, addr += 8) {
-        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, addr, src[i]) != HAL_OK) {
-            HAL_FLASH_Lock();
-            return false;
-        }
-    }
-
-    HAL_FLASH_Lock();
-#endif
+    return config_log_append(&config_log, cfg, sizeof(*cfg));
+#else
     return true;
+#endif
 }
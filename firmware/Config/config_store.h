@@ -1,6 +1,7 @@
 /**
  * Config storage in flash: region, modem preset, channels (keys), node id, short/long name.
- * Load/save on boot and on AdminMessage (set_config etc.).
+ * Load/save on boot and on AdminMessage (set_config etc.). A save appends a
+ * record to a small log (config_log.h); it does not erase the page each time.
  */
 
 #ifndef CONFIG_STORE_H
@@ -13,13 +14,34 @@
 extern "C" {
 #endif
 
+#define CONFIG_MAX_CHANNELS      8
+#define CONFIG_CHANNEL_NAME_LEN  12   /* Meshtastic channel name: up to 11 chars + null */
+#define CONFIG_PSK_MAX_LEN       32
+
+typedef struct {
+    char     name[CONFIG_CHANNEL_NAME_LEN];
+    uint8_t  psk[CONFIG_PSK_MAX_LEN];
+    uint8_t  psk_len;           /* 16 = AES-128, 32 = AES-256, 0 = unencrypted */
+} config_channel_t;
+
+/* Radio facts found at boot (lora_get_boot_info), reused by the next boot to
+ * skip the TCXO probe; trusted only while fingerprint matches the radio
+ * settings and build they were found with. */
+typedef struct {
+    uint32_t fingerprint;       /* 0 = none */
+    uint16_t image_cal;         /* CalibrateImage band */
+    uint8_t  osc;               /* RADIO_OSC_* */
+} config_radio_boot_t;
+
 typedef struct {
     uint32_t node_id;           /* our NodeID (lower 32 bits or random) */
     uint8_t  region;            /* lora_region_t */
     uint8_t  modem_preset;       /* lora_modem_preset_t */
-    uint8_t  channel_psk[16];   /* default channel AES-128 key */
+    uint8_t  channel_count;     /* valid entries in channels[]; [0] is the primary (TX) channel */
+    config_channel_t channels[CONFIG_MAX_CHANNELS];
     char     short_name[4];     /* 2–3 chars + null */
     char     long_name[32];
+    config_radio_boot_t radio_boot;   /* keep last: older records end before it */
 } device_config_t;
 
 bool config_load(device_config_t *cfg);
@@ -0,0 +1,75 @@
+/**
+ * SPSC byte ring. Same scheme as radio_rx_queue: free-running indices, a
+ * signal fence orders the data against the index update (single core; DMA
+ * on the M4 sees memory directly, no cache to maintain).
+ */
+
+#include "byte_ring.h"
+#include <stdatomic.h>
+#include <string.h>
+
+bool byte_ring_init(byte_ring_t *r, uint8_t *buf, uint16_t size) {
+    if (!r || !buf || size < 2 || size > 32768u || (size & (size - 1u)))
+        return false;
+    r->buf = buf;
+    r->mask = (uint16_t)(size - 1u);
+    r->head = 0;
+    r->tail = 0;
+    memset(&r->stats, 0, sizeof(r->stats));
+    return true;
+}
+
+uint16_t byte_ring_write(byte_ring_t *r, const uint8_t *data, uint16_t len) {
+    uint16_t space = byte_ring_free(r);
+    if (len > space) {
+        r->stats.overflows++;
+        r->stats.dropped += (uint32_t)(len - space);
+        len = space;
+    }
+    uint16_t pos = r->head & r->mask;
+    uint16_t first = (uint16_t)(r->mask + 1u - pos);
+    if (first > len) first = len;
+    memcpy(r->buf + pos, data, first);
+    memcpy(r->buf, data + first, (size_t)(len - first));
+    atomic_signal_fence(memory_order_release);
+    r->head = (uint16_t)(r->head + len);
+    r->stats.written += len;
+    uint16_t used = byte_ring_used(r);
+    if (used > r->stats.high_water) r->stats.high_water = used;
+    return len;
+}
+
+bool byte_ring_write_all(byte_ring_t *r, const uint8_t *data, uint16_t len) {
+    if (len > byte_ring_free(r)) {
+        r->stats.overflows++;
+        r->stats.dropped += len;
+        return false;
+    }
+    byte_ring_write(r, data, len);
+    return true;
+}
+
+uint16_t byte_ring_peek(const byte_ring_t *r, const uint8_t **data) {
+    uint16_t used = byte_ring_used(r);
+    uint16_t pos = r->tail & r->mask;
+    uint16_t run = (uint16_t)(r->mask + 1u - pos);
+    atomic_signal_fence(memory_order_acquire);
+    if (data) *data = r->buf + pos;
+    return used < run ? used : run;
+}
+
+void byte_ring_consume(byte_ring_t *r, uint16_t n) {
+    uint16_t used = byte_ring_used(r);
+    if (n > used) n = used;
+    atomic_signal_fence(memory_order_release);
+    r->tail = (uint16_t)(r->tail + n);
+}
+
+bool byte_ring_get(byte_ring_t *r, uint8_t *out) {
+    if (byte_ring_used(r) == 0) return false;
+    atomic_signal_fence(memory_order_acquire);
+    if (out) *out = r->buf[r->tail & r->mask];
+    atomic_signal_fence(memory_order_release);
+    r->tail = (uint16_t)(r->tail + 1u);
+    return true;
+}
@@ -0,0 +1,65 @@
+/**
+ * Single-producer / single-consumer byte ring (power-of-two size).
+ * Free-running head/tail indices: no lock needed when one side runs in an
+ * IRQ (or DMA) and the other in the main loop. The consumer can read a contiguous
+ * chunk in place (for DMA) and release it afterwards. The producer keeps
+ * its own counters (what was accepted, what did not fit, the fill peak).
+ * No HAL dependency.
+ */
+
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t written;      /* bytes accepted */
+    uint32_t dropped;      /* bytes that did not fit */
+    uint32_t overflows;    /* writes cut short or refused */
+    uint16_t high_water;   /* most bytes held at once */
+} byte_ring_stats_t;
+
+typedef struct {
+    uint8_t          *buf;
+    uint16_t          mask;    /* size - 1 */
+    volatile uint16_t head;    /* producer: next write position */
+    volatile uint16_t tail;    /* consumer: next read position */
+    byte_ring_stats_t stats;   /* producer side only */
+} byte_ring_t;
+
+/* size must be a power of two, 2..32768. Returns false otherwise. */
+bool byte_ring_init(byte_ring_t *r, uint8_t *buf, uint16_t size);
+
+static inline uint16_t byte_ring_used(const byte_ring_t *r) {
+    return (uint16_t)(r->head - r->tail);
+}
+
+static inline uint16_t byte_ring_free(const byte_ring_t *r) {
+    return (uint16_t)(r->mask + 1u - byte_ring_used(r));
+}
+
+/* Producer: copy up to len bytes, return how many fit. */
+uint16_t byte_ring_write(byte_ring_t *r, const uint8_t *data, uint16_t len);
+
+/* Producer: all len bytes or none (counted as one overflow). */
+bool byte_ring_write_all(byte_ring_t *r, const uint8_t *data, uint16_t len);
+
+/* Consumer: longest contiguous readable chunk at the tail (0 if empty). */
+uint16_t byte_ring_peek(const byte_ring_t *r, const uint8_t **data);
+
+/* Consumer: release n bytes previously returned by peek. */
+void byte_ring_consume(byte_ring_t *r, uint16_t n);
+
+/* Consumer: one byte. */
+bool byte_ring_get(byte_ring_t *r, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BYTE_RING_H */
@@ -0,0 +1,80 @@
+/**
+ * Event flags + sleep. The pending check and the sleep (WFI or STOP, see
+ * power.h) run with PRIMASK set: an interrupt that arrives in between still
+ * ends the sleep and runs right after, so no event is slept through (its
+ * handler runs after the wake-up stamp, so it counts as busy). Busy time
+ * sums DWT cycles from each wake-up to the next sleep.
+ */
+
+#include "event.h"
+#include "power.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#if defined(USE_HAL_DRIVER)
+#include "stm32wlxx_hal.h"
+#endif
+
+static _Atomic uint32_t pending = EVENT_ALL;    /* first pass runs everything */
+static uint32_t wakeups;
+static uint64_t busy_cyc;
+#if defined(USE_HAL_DRIVER)
+static uint32_t wake_cyc;
+static uint32_t start_ms;
+#endif
+static volatile bool     tick_armed;
+static volatile uint32_t tick_due_ms;
+
+void event_init(void) {
+    atomic_store(&pending, EVENT_ALL);
+    wakeups = 0;
+    busy_cyc = 0;
+#if defined(USE_HAL_DRIVER)
+    wake_cyc = DWT->CYCCNT;
+    start_ms = HAL_GetTick();
+#endif
+}
+
+void event_post(uint32_t events) {
+    atomic_fetch_or(&pending, events);
+}
+
+uint32_t event_take(void) {
+    return atomic_exchange(&pending, 0);
+}
+
+void event_systick(uint32_t now_ms) {
+    if (tick_armed && (int32_t)(now_ms - tick_due_ms) >= 0) {
+        tick_armed = false;
+        event_post(EVENT_TICK);
+    }
+}
+
+void event_wait(uint32_t idle_ms) {
+#if defined(USE_HAL_DRIVER)
+    busy_cyc += DWT->CYCCNT - wake_cyc;
+    __disable_irq();
+    /* Re-armed on every pass: the loop has just recomputed its deadline */
+    tick_due_ms = HAL_GetTick() + idle_ms;
+    tick_armed = (idle_ms != POWER_IDLE_FOREVER);
+    if (atomic_load(&pending) == 0) {
+        power_idle(idle_ms);
+        wakeups++;
+    }
+    wake_cyc = DWT->CYCCNT;
+    __enable_irq();
+#else
+    (void)idle_ms;
+#endif
+}
+
+void event_get_stats(event_stats_t *out) {
+    if (!out) return;
+    out->wakeups = wakeups;
+#if defined(USE_HAL_DRIVER)
+    out->up_ms = HAL_GetTick() - start_ms;
+    out->busy_ms = (uint32_t)((busy_cyc + (DWT->CYCCNT - wake_cyc)) / (SystemCoreClock / 1000u));
+#else
+    out->up_ms = 0;
+    out->busy_ms = 0;
+#endif
+}
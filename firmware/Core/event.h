@@ -0,0 +1,48 @@
+/**
+ * Event flags for the main loop: interrupt handlers post, the loop takes
+ * every pending flag at once and runs only the matching handlers. The tick
+ * is not periodic: each event_wait() arms it for the loop's next deadline.
+ * With nothing pending, event_wait() puts the core to sleep (WFI, or STOP
+ * when the power manager allows) until the next interrupt. Time awake is
+ * counted, so `info` can show the idle share.
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_UART_RX   0x01u   /* DMA RX half/full/IDLE, UART error */
+#define EVENT_RADIO     0x02u   /* SubGHz IRQ: RxDone, TxDone, CAD, timeout */
+#define EVENT_TICK      0x04u   /* SysTick at the loop's next deadline: timers */
+#define EVENT_ALL       0x07u
+
+typedef struct {
+    uint32_t wakeups;        /* sleep exits */
+    uint32_t up_ms;          /* since event_init */
+    uint32_t busy_ms;        /* awake (loop + interrupts), the rest asleep */
+} event_stats_t;
+
+void event_init(void);
+/* Any context (interrupt-safe read-modify-write). */
+void event_post(uint32_t events);
+/* Pending events, cleared. */
+uint32_t event_take(void);
+/* Sleep until an event is pending; returns at once if one already is.
+ * idle_ms: time until the loop's next timer (relay slot, LED, queue
+ * deadline; POWER_IDLE_FOREVER = none). EVENT_TICK is posted when it comes,
+ * and not before. */
+void event_wait(uint32_t idle_ms);
+/* From SysTick_Handler: posts EVENT_TICK once the deadline has come. */
+void event_systick(uint32_t now_ms);
+void event_get_stats(event_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_H */
@@ -0,0 +1,91 @@
+/**
+ * Line formatter.
+ */
+
+#include "fmt.h"
+#include "serial_io.h"
+#include <string.h>
+
+#define FMT_EOL_LEN 2u      /* "\r\n" kept free for a cut line */
+
+void fmt_init(fmt_t *f, char *buf, uint16_t cap) {
+    f->buf = buf;
+    f->cap = cap > FMT_EOL_LEN ? (uint16_t)(cap - FMT_EOL_LEN) : 0;
+    f->len = 0;
+    f->truncated = false;
+}
+
+void fmt_mem(fmt_t *f, const uint8_t *data, uint16_t len) {
+    if (len == 0) return;
+    uint16_t room = (uint16_t)(f->cap - f->len);
+    if (len > room) {
+        len = room;
+        f->truncated = true;
+    }
+    memcpy(f->buf + f->len, data, len);
+    f->len = (uint16_t)(f->len + len);
+}
+
+void fmt_char(fmt_t *f, char c) {
+    fmt_mem(f, (const uint8_t *)&c, 1);
+}
+
+void fmt_str(fmt_t *f, const char *s) {
+    if (s) fmt_mem(f, (const uint8_t *)s, (uint16_t)strlen(s));
+}
+
+/* Digits of v, at least min_digits (zero-padded) */
+static void put_dec(fmt_t *f, uint32_t v, uint8_t min_digits) {
+    char tmp[10];
+    uint8_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10u);
+        v /= 10u;
+    } while (v || n < min_digits);
+    while (n) fmt_char(f, tmp[--n]);
+}
+
+void fmt_u32(fmt_t *f, uint32_t v) {
+    put_dec(f, v, 1);
+}
+
+void fmt_i32(fmt_t *f, int32_t v) {
+    if (v < 0) {
+        fmt_char(f, '-');
+        put_dec(f, (uint32_t)0 - (uint32_t)v, 1);
+    } else {
+        put_dec(f, (uint32_t)v, 1);
+    }
+}
+
+void fmt_hex(fmt_t *f, uint32_t v, uint8_t digits) {
+    static const char hex[] = "0123456789abcdef";
+    if (digits < 1) digits = 1;
+    if (digits > 8) digits = 8;
+    while (digits--) fmt_char(f, hex[(v >> (4u * digits)) & 0xFu]);
+}
+
+void fmt_fixed(fmt_t *f, int32_t v, uint8_t decimals) {
+    if (decimals > 9) decimals = 9;
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) scale *= 10u;
+    uint32_t u = v < 0 ? (uint32_t)0 - (uint32_t)v : (uint32_t)v;
+    if (v < 0) fmt_char(f, '-');
+    put_dec(f, u / scale, 1);
+    if (decimals) {
+        fmt_char(f, '.');
+        put_dec(f, u % scale, decimals);
+    }
+}
+
+void fmt_flush(fmt_t *f) {
+    if (f->truncated) {
+        uint16_t n = f->len < 3u ? f->len : 3u;
+        memset(f->buf + f->len - n, '.', n);
+        f->buf[f->len++] = '\r';
+        f->buf[f->len++] = '\n';
+    }
+    serial_write((const uint8_t *)f->buf, f->len);
+    f->len = 0;
+    f->truncated = false;
+}
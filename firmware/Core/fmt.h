@@ -0,0 +1,45 @@
+/**
+ * Allocation-free line formatter: appends text and numbers to a caller's
+ * buffer, then the whole line goes to the UART in one write. Output that
+ * does not fit is cut, never overflows the buffer: the flushed line then
+ * ends in "...\r\n" (two bytes of the buffer are kept for the terminator).
+ */
+
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    char     *buf;
+    uint16_t  cap;          /* usable bytes: buffer size - 2 */
+    uint16_t  len;
+    bool      truncated;
+} fmt_t;
+
+/* cap >= 2 */
+void fmt_init(fmt_t *f, char *buf, uint16_t cap);
+void fmt_char(fmt_t *f, char c);
+void fmt_str(fmt_t *f, const char *s);
+void fmt_mem(fmt_t *f, const uint8_t *data, uint16_t len);
+void fmt_u32(fmt_t *f, uint32_t v);
+void fmt_i32(fmt_t *f, int32_t v);
+/* Zero-padded lowercase hex, digits 1..8 */
+void fmt_hex(fmt_t *f, uint32_t v, uint8_t digits);
+/* v scaled by 10^decimals: fmt_fixed(f, 869525, 3) -> "869.525" (decimals <= 9) */
+void fmt_fixed(fmt_t *f, int32_t v, uint8_t decimals);
+
+/* Write the line to the serial port in one call and start a new one; a cut
+ * line gets "..." over its last bytes and "\r\n" in the reserved room. */
+void fmt_flush(fmt_t *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMT_H */
@@ -37,6 +37,11 @@ void led_tick(void) {
     }
 }
 
+uint32_t led_idle_ms(void) {
+    uint32_t since = HAL_GetTick() - led_last_toggle_ms;
+    return since >= LED_HALF_PERIOD_MS ? 0 : LED_HALF_PERIOD_MS - since;
+}
+
 void led_toggle_from_isr(void) {
     HAL_GPIO_TogglePin(LED_GPIO_PORT, LED_GPIO_PIN);
 }
@@ -49,6 +54,10 @@ void led_init(void) {
 void led_tick(void) {
 }
 
+uint32_t led_idle_ms(void) {
+    return 0xFFFFFFFFu;
+}
+
 void led_toggle_from_isr(void) {
 }
 
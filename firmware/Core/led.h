@@ -6,8 +6,12 @@
 #ifndef FIRMWARE_CORE_LED_H
 #define FIRMWARE_CORE_LED_H
 
+#include <stdint.h>
+
 void led_init(void);
 void led_tick(void);
+/* ms until led_tick() has something to do (next toggle) */
+uint32_t led_idle_ms(void);
 /* Called from SysTick_Handler to blink LED (no dependency on main loop). */
 void led_toggle_from_isr(void);
 
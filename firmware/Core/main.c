@@ -4,6 +4,8 @@
 
 #include "../Radio/radio_phy.h"
 #include "led.h"
+#include "event.h"
+#include "power.h"
 
 #if defined(USE_HAL_DRIVER)
 #include "stm32wlxx_hal.h"
@@ -12,6 +14,7 @@
 extern void radio_stm32wl_register(void);
 extern void mesh_mini_init(void);
 extern void mesh_mini_loop(void);
+extern uint32_t mesh_mini_idle_ms(void);
 
 /* Weak stub: implement in project (HAL_UART_Transmit etc.). */
 __attribute__((weak)) void uart_tx(const uint8_t *data, uint16_t len) {
@@ -22,22 +25,29 @@ __attribute__((weak)) void uart_tx(const uint8_t *data, uint16_t len) {
 #if defined(USE_HAL_DRIVER)
 #include "serial_io.h"
 extern void SystemClock_Config_LL(void);
+extern void cyccnt_init(void);
 #endif
 
 int main(void) {
 #if defined(USE_HAL_DRIVER)
     /* 48 MHz via LL before HAL so SysTick = 1 ms (no HAL timeouts during clock switch) */
     SystemClock_Config_LL();
+    cyccnt_init();
     HAL_Init();
     serial_init();   /* main serial USART1 115200 */
 #endif
     /* Register STM32WL driver (when built with USE_STM32WL_RADIO). */
     radio_stm32wl_register();
 
+    event_init();
+    power_stm32wl_init();
     mesh_mini_init();
     serial_puts("Meshtastic_mini started\r\n");
     serial_puts("mesh init done, loop\r\n");
 
-    for (;;)
+    /* Run what interrupts posted, then sleep (WFI or STOP) until the next one */
+    for (;;) {
         mesh_mini_loop();
+        event_wait(mesh_mini_idle_ms());
+    }
 }
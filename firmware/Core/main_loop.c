@@ -1,5 +1,5 @@
 /**
- * Main loop: LoRa RX → decrypt → protobuf decode → UART;
+ * Main loop: LoRa RX (borrowed ring slot) → decrypt in place → protobuf decode → UART;
  *            UART line → protobuf encode → encrypt → LoRa TX.
  *
  * Over-the-air format (Meshtastic-compatible):
@@ -8,238 +8,756 @@
 
 #include "led.h"
 #include "serial_io.h"
+#include "fmt.h"
+#include "event.h"
+#include "power.h"
+#include "profile.h"
 #include "../Radio/lora_meshtastic.h"
 #if defined(USE_HAL_DRIVER)
 #include "stm32wlxx_hal.h"
 #endif
 #include "../Mesh/mesh_packet.h"
 #include "../Mesh/flood_router.h"
+#include "../Mesh/tx_queue.h"
+#include "../Mesh/mesh_data.h"
 #include "../Config/config_store.h"
 #include "../Crypto/aes_meshtastic.h"
+#include "../Mesh/channel_table.h"
+#include "../Serial/serial_framing.h"
+#include "../Serial/serial_api.h"
 #include <string.h>
 
-#define LORA_BUF_SIZE 256
-#define LINE_BUF_SIZE 200
+#define LINE_BUF_SIZE (MESH_DATA_PAYLOAD_MAX + 1)
 
-#define PORTNUM_TEXT_MESSAGE 1
-
-static uint8_t lora_rx_buf[LORA_BUF_SIZE];
-static uint8_t lora_tx_buf[LORA_BUF_SIZE];
 static device_config_t g_config;
 static uint32_t next_packet_id;
 
 static uint8_t line_buf[LINE_BUF_SIZE];
 static uint16_t line_len;
+static serial_rx_ctx_t api_rx;
 
-/* --- Minimal protobuf encode/decode for Meshtastic Data message --- */
+static volatile bool tx_timed_out;    /* set from the radio IRQ via tx_done callback */
+static volatile bool tx_channel_busy; /* LBT gave up on a frame */
 
-/* Encode Data{portnum, payload} → protobuf bytes.
- * Returns encoded length, 0 on error. */
-static uint16_t pb_encode_data(uint8_t *out, uint16_t max_out,
-                               uint8_t portnum,
-                               const uint8_t *payload, uint16_t payload_len)
-{
-    uint16_t need = 2 + 2 + payload_len;
-    if (need > max_out || payload_len > 127) return 0;
-    uint16_t p = 0;
-    out[p++] = 0x08;              /* field 1 (portnum), wire=varint */
-    out[p++] = portnum;
-    out[p++] = 0x12;              /* field 2 (payload), wire=length-delimited */
-    out[p++] = (uint8_t)payload_len;
-    memcpy(out + p, payload, payload_len);
-    return (uint16_t)(p + payload_len);
-}
-
-/* Decode Data protobuf → portnum + payload pointer/length.
- * Returns true if payload field found. */
-static bool pb_decode_data(const uint8_t *data, uint16_t len,
-                           uint8_t *portnum,
-                           const uint8_t **payload, uint16_t *payload_len)
+/* xorshift32 for relay contention slots; stirred with RX timing/RSSI */
+static uint32_t rng_state = 0x6D2B79F5u;
+
+static void rng_mix(uint32_t v) {
+    rng_state ^= v * 0x9E3779B1u;
+    if (rng_state == 0) rng_state = 0x6D2B79F5u;
+}
+
+static uint32_t rng_next(void) {
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static uint32_t now_ms(void) {
+#if defined(USE_HAL_DRIVER)
+    return HAL_GetTick();
+#else
+    return 0;
+#endif
+}
+
+/* --- Packet send/receive with encryption --- */
+
+static void on_tx_done(radio_tx_result_t result) {
+    if (result == RADIO_TX_TIMEOUT) tx_timed_out = true;
+    else if (result == RADIO_TX_CHANNEL_BUSY) tx_channel_busy = true;
+}
+
+/* Channel whose key is loaded in the AES engine; keys are switched only when
+ * a frame for another channel is encrypted or decrypted. */
+static uint8_t active_channel = 0xFF;
+
+/* Encrypt/decrypt in place with channel idx's key (CTR: same operation).
+ * Channels without a PSK are sent in the clear. */
+static void channel_crypt(uint8_t idx, uint8_t *payload, uint16_t len,
+                          uint32_t packet_id, uint32_t from_id)
 {
-    *portnum = 0;
-    *payload = NULL;
-    *payload_len = 0;
-
-    uint16_t pos = 0;
-    while (pos < len) {
-        if (pos >= len) break;
-        uint8_t tag = data[pos++];
-        uint8_t field = tag >> 3;
-        uint8_t wire  = tag & 0x07;
-
-        if (wire == 0) {          /* varint */
-            uint32_t val = 0;
-            unsigned shift = 0;
-            while (pos < len) {
-                uint8_t b = data[pos++];
-                val |= (uint32_t)(b & 0x7F) << shift;
-                if (!(b & 0x80)) break;
-                shift += 7;
-            }
-            if (field == 1) *portnum = (uint8_t)val;
-        } else if (wire == 2) {   /* length-delimited */
-            if (pos >= len) break;
-            uint32_t flen = 0;
-            unsigned shift = 0;
-            while (pos < len) {
-                uint8_t b = data[pos++];
-                flen |= (uint32_t)(b & 0x7F) << shift;
-                if (!(b & 0x80)) break;
-                shift += 7;
-            }
-            if (field == 2 && flen <= (uint32_t)(len - pos)) {
-                *payload = data + pos;
-                *payload_len = (uint16_t)flen;
-            }
-            pos += flen;
-        } else if (wire == 5) {   /* fixed32 */
-            pos += 4;
-        } else if (wire == 1) {   /* fixed64 */
-            pos += 8;
-        } else {
-            break;
-        }
+    PROF_BEGIN(t);
+    const config_channel_t *c = channel_table_get(idx);
+    if (!c || c->psk_len == 0) return;
+    if (active_channel != idx) {
+        if (!aes_set_channel_key(c->psk, c->psk_len)) return;
+        active_channel = idx;
     }
-    return (*payload != NULL);
+    aes_ctr_crypt(payload, len, packet_id, from_id);
+    PROF_END(PROF_AES_CTR, t);
 }
 
-/* --- Packet send/receive with encryption --- */
+/* Build the frame directly in a reserved TX queue slot; the main loop hands
+ * queued frames to the radio in priority order (see service_tx_queue). */
+static bool send_mesh_data(uint32_t to_id, uint32_t packet_id, uint8_t flags,
+                           const mesh_data_t *d, txq_prio_t prio, uint8_t chan)
+{
+    uint8_t *frame = tx_queue_reserve(prio, now_ms(), 0);
+    if (!frame) return false;
 
-static bool send_lora_packet(uint32_t to_id, const uint8_t *text, uint16_t text_len) {
-    /* Encode Data protobuf */
-    uint8_t pb_buf[LORA_BUF_SIZE - MESH_HEADER_SIZE];
-    uint16_t pb_len = pb_encode_data(pb_buf, sizeof(pb_buf),
-                                     PORTNUM_TEXT_MESSAGE, text, text_len);
-    if (pb_len == 0) return false;
+    /* Encode Data protobuf in place after the header */
+    uint16_t pb_len = mesh_data_encode(d, frame + MESH_HEADER_SIZE,
+                                       MESH_MAX_FRAME - MESH_HEADER_SIZE);
+    if (pb_len == 0) {
+        tx_queue_abort();
+        return false;
+    }
 
     mesh_lora_header_t h = {
         .to_id     = to_id,
         .from_id   = g_config.node_id,
-        .packet_id = next_packet_id++,
-        .flags     = 3,
-        .channel   = 0,
+        .packet_id = packet_id,
+        .flags     = flags,
+        .channel   = channel_table_hash(chan),
         .next_hop  = 0,
         .relay     = 0,
     };
-    mesh_header_to_buf(&h, lora_tx_buf);
+    mesh_header_to_buf(&h, frame);
 
-    memcpy(lora_tx_buf + MESH_HEADER_SIZE, pb_buf, pb_len);
+    /* Encrypt payload (after header) with the channel's key */
+    channel_crypt(chan, frame + MESH_HEADER_SIZE, pb_len, h.packet_id, h.from_id);
 
-    /* Encrypt payload (after header) with AES-CTR */
-    aes_ctr_crypt(lora_tx_buf + MESH_HEADER_SIZE, pb_len,
-                  h.packet_id, h.from_id);
+    flood_seen(h.from_id, h.packet_id, now_ms());
+    tx_queue_commit(MESH_HEADER_SIZE + pb_len);
+    return true;
+}
 
-    flood_seen(h.from_id, h.packet_id);
-    return lora_tx(lora_tx_buf, MESH_HEADER_SIZE + pb_len);
+static bool send_lora_packet(uint32_t to_id, const uint8_t *text, uint16_t text_len,
+                             txq_prio_t prio, uint8_t chan)
+{
+    mesh_data_t d = {
+        .portnum     = MESH_PORTNUM_TEXT_MESSAGE,
+        .payload     = text,
+        .payload_len = text_len,
+    };
+    return send_mesh_data(to_id, next_packet_id++, 3, &d, prio, chan);
 }
 
-static void uart_rx_line_poll(void) {
-    uint8_t b;
-    while (serial_get_byte(&b)) {
-        if (b == '\r' || b == '\n') {
-            if (line_len == 0) continue;
-            line_buf[line_len] = '\0';
+/* ToRadio.packet from a serial client: sent as given (id, hop limit, want_ack)
+ * on the requested channel index; our node is always the sender. A hop
+ * limit above the 3-bit field is clamped to 7, not wrapped. */
+static void api_send(const serial_api_packet_t *p) {
+    if (p->channel >= channel_table_count()) return;
+    uint8_t hop_limit = p->hop_limit ? p->hop_limit : 3;
+    if (hop_limit > MESH_HOP_LIMIT_MAX) hop_limit = MESH_HOP_LIMIT_MAX;
+    uint8_t flags = (uint8_t)(hop_limit | (p->want_ack ? MESH_FLAG_WANT_ACK : 0) |
+                              (hop_limit << MESH_HOP_START_SHIFT));
+    uint32_t id = p->id ? p->id : next_packet_id++;
+    send_mesh_data(p->to ? p->to : MESH_BROADCAST_ID, id, flags, &p->data,
+                   TXQ_PRIO_APP, p->channel);
+}
 
-            if (line_len >= 2 && (line_buf[0] == 'N' || line_buf[0] == 'n')) {
-                if (line_buf[1] >= '1' && line_buf[1] <= '9') {
-                    g_config.node_id = (uint32_t)(line_buf[1] - '0');
-                    serial_puts("node_id set\r\n");
-                }
-                line_len = 0;
-                continue;
-            }
+/* "info": one formatted line per subsystem, each sent in a single write */
+static void print_info(void) {
+    char buf[112];
+    fmt_t f;
+    fmt_init(&f, buf, sizeof(buf));
+
+    lora_params_t params;
+    lora_get_params(&params);
+    fmt_str(&f, "Freq: ");
+    fmt_fixed(&f, (int32_t)(params.freq_hz / 1000u), 3);
+    fmt_str(&f, " MHz  SF: ");
+    fmt_u32(&f, params.sf);
+    fmt_str(&f, "  NodeId: ");
+    fmt_u32(&f, g_config.node_id);
+    fmt_str(&f, " (!");
+    fmt_hex(&f, g_config.node_id, 8);
+    fmt_str(&f, ")  Last RSSI: ");
+    fmt_i32(&f, lora_last_rssi());
+    fmt_str(&f, " dBm\r\n");
+    fmt_flush(&f);
+
+    lora_duty_stats_t dc;
+    lora_duty_get_stats(&dc, now_ms());
+    fmt_str(&f, "Airtime 1h: ");
+    fmt_fixed(&f, (int32_t)(dc.used_ms / 100u), 1);
+    fmt_str(&f, " s");
+    if (dc.limit_permille) {
+        fmt_str(&f, " of ");
+        fmt_u32(&f, dc.budget_ms / 1000u);
+        fmt_str(&f, " s (");
+        fmt_fixed(&f, dc.limit_permille, 1);
+        fmt_str(&f, "% duty)");
+    }
+    fmt_str(&f, "  deferred: ");
+    fmt_u32(&f, dc.deferred);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
 
-            if (line_len == 4 && line_buf[0] == 'h' && line_buf[1] == 'e' &&
-                line_buf[2] == 'l' && line_buf[3] == 'p') {
-                serial_puts("Commands: N1..N9, info, help. Any other text = send over LoRa.\r\n");
-                line_len = 0;
-                continue;
+    radio_rx_stats_t rxs;
+    lora_get_rx_stats(&rxs);
+    fmt_str(&f, "RX frames: ");
+    fmt_u32(&f, rxs.received);
+    fmt_str(&f, "  overflow: ");
+    fmt_u32(&f, rxs.overflows);
+    fmt_str(&f, "  errors: ");
+    fmt_u32(&f, rxs.errors);
+    fmt_str(&f, "  max depth: ");
+    fmt_u32(&f, rxs.high_water);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+    fmt_str(&f, "RxDone->SetRx us: ");
+    fmt_u32(&f, rxs.restart_last_us);
+    fmt_str(&f, " (avg ");
+    fmt_u32(&f, rxs.restart_avg_us);
+    fmt_str(&f, ", max ");
+    fmt_u32(&f, rxs.restart_max_us);
+    fmt_str(&f, ")\r\n");
+    fmt_flush(&f);
+
+    flood_dedup_stats_t ds;
+    flood_get_stats(&ds, now_ms());
+    fmt_str(&f, "Dedup: ");
+    fmt_u32(&f, ds.occupancy);
+    fmt_char(&f, '/');
+    fmt_u32(&f, ds.capacity);
+    fmt_str(&f, "  dups: ");
+    fmt_u32(&f, ds.hits);
+    fmt_str(&f, "  expired: ");
+    fmt_u32(&f, ds.expired);
+    fmt_str(&f, "  evicted: ");
+    fmt_u32(&f, ds.evictions);
+    fmt_str(&f, "  probe: ");
+    fmt_u32(&f, ds.probe_len);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+
+    flood_relay_stats_t rs;
+    flood_get_relay_stats(&rs);
+    fmt_str(&f, "Relays sent: ");
+    fmt_u32(&f, rs.sent);
+    fmt_str(&f, "  suppressed: ");
+    fmt_u32(&f, rs.suppressed);
+    fmt_str(&f, "  dropped: ");
+    fmt_u32(&f, rs.dropped);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+
+    tx_queue_stats_t qs;
+    tx_queue_get_stats(&qs);
+    fmt_str(&f, "TX queue: ");
+    fmt_u32(&f, qs.depth);
+    fmt_str(&f, " (max ");
+    fmt_u32(&f, qs.high_water);
+    fmt_str(&f, ")  sent: ");
+    fmt_u32(&f, qs.sent);
+    fmt_str(&f, "  rejected: ");
+    fmt_u32(&f, qs.rejected);
+    fmt_str(&f, "  evicted: ");
+    fmt_u32(&f, qs.evicted);
+    fmt_str(&f, "  expired: ");
+    fmt_u32(&f, qs.expired);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+
+    radio_lbt_stats_t ls;
+    lora_get_lbt_stats(&ls);
+    fmt_str(&f, "LBT CAD: ");
+    fmt_u32(&f, ls.cad_runs);
+    fmt_str(&f, "  busy: ");
+    fmt_u32(&f, ls.cad_busy);
+    fmt_str(&f, "  backoffs: ");
+    fmt_u32(&f, ls.backoffs);
+    fmt_str(&f, "  gave up: ");
+    fmt_u32(&f, ls.give_ups);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+
+    channel_stats_t cs;
+    channel_table_get_stats(&cs);
+    fmt_str(&f, "Channels: ");
+    fmt_u32(&f, channel_table_count());
+    fmt_str(&f, "  primary hash: 0x");
+    fmt_hex(&f, channel_table_hash(0), 2);
+    fmt_str(&f, "  lookups: ");
+    fmt_u32(&f, cs.lookups);
+    fmt_str(&f, "  skipped: ");
+    fmt_u32(&f, cs.skipped);
+    fmt_str(&f, "  undecodable: ");
+    fmt_u32(&f, cs.undecodable);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+
+    serial_tx_stats_t ts;
+    serial_rx_stats_t us;
+    serial_get_tx_stats(&ts);
+    serial_get_rx_stats(&us);
+    fmt_str(&f, "UART TX: ");
+    fmt_u32(&f, ts.pending);
+    fmt_str(&f, " (max ");
+    fmt_u32(&f, ts.high_water);
+    fmt_str(&f, ")  dropped: ");
+    fmt_u32(&f, ts.dropped);
+    fmt_str(&f, "  RX overruns: ");
+    fmt_u32(&f, us.overruns);
+    fmt_str(&f, "  errors: ");
+    fmt_u32(&f, us.errors);
+    fmt_str(&f, "  dropped: ");
+    fmt_u32(&f, us.dropped);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+
+    event_stats_t es;
+    event_get_stats(&es);
+    fmt_str(&f, "CPU busy: ");
+    fmt_u32(&f, es.busy_ms);
+    fmt_str(&f, " of ");
+    fmt_u32(&f, es.up_ms);
+    fmt_str(&f, " ms (");
+    fmt_fixed(&f, es.up_ms ? (int32_t)((uint64_t)es.busy_ms * 1000u / es.up_ms) : 0, 1);
+    fmt_str(&f, "%)  wakeups: ");
+    fmt_u32(&f, es.wakeups);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+
+    power_stats_t ps;
+    power_get_stats(&ps);
+    fmt_str(&f, "Power ms: run ");
+    fmt_u32(&f, ps.ms[POWER_RUN]);
+    fmt_str(&f, "  sleep ");
+    fmt_u32(&f, ps.ms[POWER_SLEEP]);
+    fmt_str(&f, " (");
+    fmt_u32(&f, ps.entries[POWER_SLEEP]);
+    fmt_str(&f, "x)  stop ");
+    fmt_u32(&f, ps.ms[POWER_STOP]);
+    fmt_str(&f, " (");
+    fmt_u32(&f, ps.entries[POWER_STOP]);
+    fmt_str(&f, "x)\r\n");
+    fmt_flush(&f);
+
+    fmt_str(&f, "API frames: ");
+    fmt_u32(&f, api_rx.frames);
+    fmt_str(&f, "  framing errors: ");
+    fmt_u32(&f, api_rx.framing_errors);
+    fmt_str(&f, "  resync bytes: ");
+    fmt_u32(&f, api_rx.resync_bytes);
+    fmt_str(&f, "\r\n");
+    fmt_flush(&f);
+}
+
+/* Per-stage profile since the last `stats`, then reset */
+static void print_stats(void) {
+#if MESH_PROFILE
+    prof_stat_t st[PROF_STAGE_COUNT];
+    prof_take(st);
+    char buf[96];
+    fmt_t f;
+    fmt_init(&f, buf, sizeof(buf));
+    fmt_str(&f, "Stage: count  min / avg / max (");
+    fmt_str(&f, prof_unit());
+    fmt_str(&f, ")\r\n");
+    fmt_flush(&f);
+    for (int i = 0; i < PROF_STAGE_COUNT; i++) {
+        const prof_stat_t *s = &st[i];
+        fmt_str(&f, prof_stage_name((prof_stage_t)i));
+        fmt_str(&f, ": ");
+        fmt_u32(&f, s->count);
+        if (s->count) {
+            fmt_str(&f, "  ");
+            fmt_u32(&f, s->min);
+            fmt_str(&f, " / ");
+            fmt_u32(&f, (uint32_t)(s->sum / s->count));
+            fmt_str(&f, " / ");
+            fmt_u32(&f, s->max);
+        }
+        fmt_str(&f, "\r\n");
+        fmt_flush(&f);
+    }
+#else
+    serial_puts("Profiling off: build with -DMESH_PROFILE=ON.\r\n");
+#endif
+}
+
+/* One byte of the text protocol: commands, or a line to send over LoRa */
+static void uart_line_byte(uint8_t b) {
+    if (b == '\r' || b == '\n') {
+        if (line_len == 0) return;
+        line_buf[line_len] = '\0';
+
+        if (line_len >= 2 && (line_buf[0] == 'N' || line_buf[0] == 'n')) {
+            if (line_buf[1] >= '1' && line_buf[1] <= '9') {
+                g_config.node_id = (uint32_t)(line_buf[1] - '0');
+                serial_puts("node_id set\r\n");
             }
+            line_len = 0;
+            return;
+        }
 
-            if (line_len == 4 && line_buf[0] == 'i' && line_buf[1] == 'n' &&
-                line_buf[2] == 'f' && line_buf[3] == 'o') {
-                lora_params_t params;
-                lora_get_params(&params);
-                serial_puts("Freq: ");
-                serial_put_int16((int16_t)(params.freq_hz / 1000000));
-                serial_puts(" MHz  SF: ");
-                serial_put_int16((int16_t)params.sf);
-                serial_puts("  NodeId: ");
-                serial_put_int16((int16_t)g_config.node_id);
-                serial_puts("  Last RSSI: ");
-                serial_put_int16(lora_last_rssi());
-                serial_puts(" dBm\r\n");
-                line_len = 0;
-                continue;
+        if (line_len == 4 && line_buf[0] == 'h' && line_buf[1] == 'e' &&
+            line_buf[2] == 'l' && line_buf[3] == 'p') {
+            serial_puts("Commands: N1..N9, info, stats, aes, help. Any other text = send over LoRa.\r\n");
+            line_len = 0;
+            return;
+        }
+
+        if (line_len == 3 && line_buf[0] == 'a' && line_buf[1] == 'e' &&
+            line_buf[2] == 's') {
+            char buf[80];
+            fmt_t f;
+            fmt_init(&f, buf, sizeof(buf));
+            fmt_str(&f, "AES ");
+            fmt_str(&f, aes_backend_name());
+            fmt_str(&f, aes_self_test() ? ": self-test ok" : ": self-test FAILED");
+            uint32_t ctr_cyc, ecb_cyc;
+            if (aes_hw_cycles(237, &ctr_cyc, &ecb_cyc)) {
+                fmt_str(&f, ", 237 B: ctr ");
+                fmt_u32(&f, ctr_cyc);
+                fmt_str(&f, " cyc, ecb ");
+                fmt_u32(&f, ecb_cyc);
+                fmt_str(&f, " cyc");
             }
+            fmt_str(&f, "\r\n");
+            fmt_flush(&f);
+            line_len = 0;
+            return;
+        }
 
-            if (send_lora_packet(MESH_BROADCAST_ID, line_buf, line_len))
-                serial_puts("Sent.\r\n");
-            else
-                serial_puts("TX failed.\r\n");
+        if (line_len == 4 && line_buf[0] == 'i' && line_buf[1] == 'n' &&
+            line_buf[2] == 'f' && line_buf[3] == 'o') {
+            print_info();
             line_len = 0;
-            continue;
+            return;
         }
-        if (line_len < LINE_BUF_SIZE - 1)
-            line_buf[line_len++] = b;
+
+        if (line_len == 5 && memcmp(line_buf, "stats", 5) == 0) {
+            print_stats();
+            line_len = 0;
+            return;
+        }
+
+        bool queued = send_lora_packet(MESH_BROADCAST_ID, line_buf, line_len, TXQ_PRIO_APP, 0);
+        if (!serial_api_active())
+            serial_puts(queued ? "Queued.\r\n" : "TX queue full.\r\n");
+        line_len = 0;
+        return;
     }
+    if (line_len < LINE_BUF_SIZE - 1)
+        line_buf[line_len++] = b;
 }
 
-void mesh_mini_loop(void) {
-    led_tick();
-    uart_rx_line_poll();
-
-    uint16_t n = lora_rx_poll(lora_rx_buf, LORA_BUF_SIZE);
-    if (n <= MESH_HEADER_SIZE) return;
+/* Received spans are read in place. Framed ToRadio (0x94 0xC3 ...) goes to
+ * the API parser, anything else is text; a frame in progress keeps the
+ * parser until it completes or is abandoned. */
+static void uart_rx_poll(void) {
+    const uint8_t *span;
+    uint16_t n;
+    while ((n = serial_rx_peek(&span)) != 0) {
+        uint16_t i = 0;
+        while (i < n) {
+            if (!serial_rx_idle(&api_rx) || (span[i] == SERIAL_START1 && line_len == 0))
+                i = (uint16_t)(i + serial_rx_feed(&api_rx, span + i, (uint16_t)(n - i)));
+            else
+                uart_line_byte(span[i++]);
+        }
+        serial_rx_consume(n);
+    }
+}
 
+/* Process one received frame in place in the borrowed RX slot: the header is
+ * parsed into a local struct and the payload is decrypted in place. The only
+ * copy is the relay frame, taken (still encrypted) when a relay is scheduled. */
+static void handle_rx_frame(radio_rx_frame_t *f) {
+    uint8_t *frame = f->data;
+    uint16_t n = f->len;
     mesh_lora_header_t h;
-    mesh_header_from_buf(&h, lora_rx_buf);
-    bool should_fwd = flood_should_forward(lora_rx_buf, n);
-    flood_seen(h.from_id, h.packet_id);
-
-    if (h.to_id == MESH_BROADCAST_ID || h.to_id == g_config.node_id) {
-        uint16_t enc_len = n - MESH_HEADER_SIZE;
-        uint8_t dec_buf[LORA_BUF_SIZE];
-        memcpy(dec_buf, lora_rx_buf + MESH_HEADER_SIZE, enc_len);
-
-        /* Decrypt with AES-CTR (same function for encrypt/decrypt) */
-        aes_ctr_crypt(dec_buf, enc_len, h.packet_id, h.from_id);
-
-        /* Decode Data protobuf */
-        uint8_t portnum = 0;
-        const uint8_t *text = NULL;
-        uint16_t text_len = 0;
-
-        if (pb_decode_data(dec_buf, enc_len, &portnum, &text, &text_len) &&
-            text_len > 0)
-        {
-            serial_puts("RX: ");
-            serial_write(text, text_len);
-            serial_puts("  RSSI: ");
-            serial_put_int16(lora_last_rssi());
-            serial_puts(" dBm  SNR: ");
-            serial_put_int16((int16_t)lora_last_snr());
-            serial_puts(" dB\r\n");
-
-            /* Auto-reply "pong" (unless we received "pong") */
-            if (text_len != 4 || memcmp(text, "pong", 4) != 0) {
-                const char pong[] = "pong";
-                send_lora_packet(h.from_id, (const uint8_t *)pong, 4);
-            }
+    PROF_BEGIN(t_hdr);
+    mesh_header_from_buf(&h, frame);
+    PROF_END(PROF_HDR_PARSE, t_hdr);
+    rng_mix(f->rx_ms ^ ((uint32_t)(uint16_t)f->rssi << 16));
+
+    /* Dedup: one probe both checks and records (from_id, packet_id).
+     * A duplicate means someone else already relayed it: cancel ours. */
+    PROF_BEGIN(t_dedup);
+    bool dup = flood_check_and_insert(h.from_id, h.packet_id, now_ms());
+    PROF_END(PROF_DEDUP, t_dedup);
+    if (dup) {
+        flood_on_duplicate(h.from_id, h.packet_id);
+        return;
+    }
+
+    /* Managed flooding: relay after an SNR-weighted contention delay */
+    if (mesh_hop_limit(h.flags) > 0) {
+        flood_schedule_relay(frame, n, f->snr, (uint8_t)(g_config.node_id & 0xFF),
+                             rng_next(), now_ms());
+    }
+
+    if (h.to_id != MESH_BROADCAST_ID && h.to_id != g_config.node_id) return;
+
+    /* Channel hash picks the candidate keys; none = not our channel, and
+     * the frame is dropped without touching AES. */
+    uint8_t cand = channel_table_candidates(h.channel);
+    if (cand == 0) return;
+
+    uint8_t *payload = frame + MESH_HEADER_SIZE;
+    uint16_t enc_len = n - MESH_HEADER_SIZE;
+    mesh_data_t data;
+    uint8_t chan = 0;
+    bool decoded = false;
+
+    /* Decrypt in place with each candidate until the Data protobuf decodes.
+     * A hash collision is rare; a wrong key is undone by running CTR again. */
+    for (; cand != 0; chan++, cand >>= 1) {
+        if (!(cand & 1u)) continue;
+        channel_crypt(chan, payload, enc_len, h.packet_id, h.from_id);
+        PROF_BEGIN(t_pb);
+        decoded = mesh_data_decode(payload, enc_len, &data);
+        PROF_END(PROF_PB_DECODE, t_pb);
+        if (decoded) break;
+        if (cand >> 1)
+            channel_crypt(chan, payload, enc_len, h.packet_id, h.from_id);
+    }
+    if (!decoded) {
+        channel_table_note_undecodable();
+        return;
+    }
+
+    /* A connected client gets every decoded packet as FromRadio.packet */
+    if (serial_api_active()) {
+        serial_api_packet_t p = {
+            .from      = h.from_id,
+            .to        = h.to_id,
+            .id        = h.packet_id,
+            .channel   = chan,
+            .hop_limit = h.flags & 0x07,
+            .hop_start = h.flags >> MESH_HOP_START_SHIFT,
+            .want_ack  = (h.flags & MESH_FLAG_WANT_ACK) != 0,
+            .rx_rssi   = f->rssi,
+            .rx_snr    = f->snr,
+            .data      = data,
+        };
+        PROF_BEGIN(t_out);
+        serial_api_send_packet(&p);
+        PROF_END(PROF_UART_OUT, t_out);
+    }
+
+    /* Only text is shown (and answered); other ports (position, nodeinfo,
+     * telemetry, ...) are relayed but not printed. */
+    if (data.portnum == MESH_PORTNUM_TEXT_MESSAGE && data.payload_len > 0) {
+        if (!serial_api_active()) {
+            PROF_BEGIN(t_out);
+            char buf[MESH_DATA_PAYLOAD_MAX + 40];
+            fmt_t fl;
+            fmt_init(&fl, buf, sizeof(buf));
+            fmt_str(&fl, "RX: ");
+            fmt_mem(&fl, data.payload, data.payload_len);
+            fmt_str(&fl, "  RSSI: ");
+            fmt_i32(&fl, f->rssi);
+            fmt_str(&fl, " dBm  SNR: ");
+            fmt_i32(&fl, f->snr);
+            fmt_str(&fl, " dB\r\n");
+            fmt_flush(&fl);
+            PROF_END(PROF_UART_OUT, t_out);
+        }
+
+        /* Auto-reply "pong" (unless we received "pong") */
+        if (data.payload_len != 4 || memcmp(data.payload, "pong", 4) != 0) {
+            const char pong[] = "pong";
+            send_lora_packet(h.from_id, (const uint8_t *)pong, 4, TXQ_PRIO_ACK, chan);
+        }
+    }
+}
+
+/* Move due relays into the TX queue, then give the radio the next queued
+ * frame if it is idle. One frame on air at a time. */
+static void service_tx_queue(void) {
+    flood_relay_t *r;
+    while ((r = flood_due_relay(now_ms())) != NULL) {
+        bool queued = tx_queue_push(r->frame, r->len, TXQ_PRIO_RELAY, now_ms(), 0);
+        flood_relay_done(r, queued);
+    }
+
+    if (lora_tx_busy()) return;
+    const tx_queue_entry_t *e = tx_queue_next(now_ms());
+    if (!e) return;
+    /* Regulatory duty cycle: hold the frame until the window has room (its
+     * queue deadline still applies). Charged at start, so an LBT give-up errs
+     * on the safe side. */
+    uint32_t airtime = lora_airtime_ms(e->len);
+    if (!lora_duty_allows(airtime, now_ms())) return;
+    PROF_BEGIN(t_tx);
+    bool ok = lora_tx(e->frame, e->len);
+    PROF_END(PROF_TX, t_tx);
+    if (ok) lora_duty_charge(airtime, now_ms());
+    tx_queue_pop(ok);
+    if (!ok && !serial_api_active()) serial_puts("TX failed.\r\n");
+}
+
+/* One pass per wake-up: only the handlers for pending events run. The TX
+ * queue is serviced on every pass, since any of them may have queued a frame
+ * and its timers (deadlines, relays, duty cycle) run on EVENT_TICK, which
+ * comes at mesh_mini_idle_ms(). */
+void mesh_mini_loop(void) {
+    PROF_BEGIN(t_loop);
+    uint32_t ev = event_take();
+
+    if (ev & EVENT_TICK)
+        led_tick();
+    if (ev & (EVENT_TICK | EVENT_RADIO)) {
+        lora_service();
+        if (tx_timed_out) {
+            tx_timed_out = false;
+            if (!serial_api_active()) serial_puts("TX timeout.\r\n");
+        }
+        if (tx_channel_busy) {
+            tx_channel_busy = false;
+            if (!serial_api_active()) serial_puts("TX dropped: channel busy.\r\n");
+        }
+    }
+    if (ev & EVENT_UART_RX)
+        uart_rx_poll();
+    if (ev & EVENT_RADIO) {
+        radio_rx_frame_t *f;
+        while ((f = lora_rx_borrow()) != NULL) {
+            if (f->len > MESH_HEADER_SIZE)
+                handle_rx_frame(f);
+            lora_rx_release();
         }
     }
+    service_tx_queue();
+    PROF_END(PROF_LOOP, t_loop);
+}
+
+/* How long the loop can sleep before a timer needs it (event_wait arms the
+ * tick for it, power_idle picks the sleep depth from it): 0 while
+ * a frame is queued or on air (deadlines, duty cycle, LBT backoff run on
+ * the 1 ms tick), else until the next relay slot or LED toggle. */
+uint32_t mesh_mini_idle_ms(void) {
+    tx_queue_stats_t qs;
+    tx_queue_get_stats(&qs);
+    if (qs.depth || lora_tx_busy()) return 0;
+    uint32_t idle = led_idle_ms();
+    uint32_t relay;
+    if (flood_next_relay_ms(now_ms(), &relay) && relay < idle) idle = relay;
+    return idle;
+}
+
+/* --- Boot --- */
+
+/* Cycle counter for the boot breakdown (0 without the HAL) */
+static uint32_t boot_cycles(void) {
+#if defined(USE_HAL_DRIVER)
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
+
+static uint32_t boot_us(uint32_t cycles) {
+#if defined(USE_HAL_DRIVER)
+    return cycles / (SystemCoreClock / 1000000u);
+#else
+    return cycles;
+#endif
+}
+
+/* Boot hints are valid for one radio setup and board build: anything that
+ * could change the oscillator or the calibration band changes this. */
+static uint32_t radio_boot_fingerprint(lora_region_t region, lora_modem_preset_t preset) {
+    uint8_t in[6] = {
+        1,                      /* hint format */
+        (uint8_t)region,
+        (uint8_t)preset,
+#if defined(WIO_E5_NO_TCXO)
+        1,
+#else
+        0,
+#endif
+#if defined(WIO_E5_USE_LP)
+        1,
+#else
+        0,
+#endif
+#if defined(WIO_E5_RF_SWAP)
+        1,
+#else
+        0,
+#endif
+    };
+    uint32_t h = 2166136261u;   /* FNV-1a */
+    for (uint8_t i = 0; i < sizeof(in); i++)
+        h = (h ^ in[i]) * 16777619u;
+    return h ? h : 1u;
+}
 
-    if (should_fwd) {
-        flood_prepare_forward(lora_rx_buf, n, (uint8_t)(g_config.node_id & 0xFF));
-        lora_tx(lora_rx_buf, n);
+static void print_boot(const uint32_t *us, uint32_t first_rx_ms, bool hinted) {
+    static const char *const names[] = { "config ", "  radio ", "  region ", "  mesh " };
+    char buf[112];
+    fmt_t f;
+    fmt_init(&f, buf, sizeof(buf));
+    fmt_str(&f, "Boot ms: ");
+    for (uint8_t i = 0; i < 4; i++) {
+        fmt_str(&f, names[i]);
+        fmt_fixed(&f, (int32_t)us[i], 3);
     }
+    fmt_str(&f, "  first RX at ");
+    fmt_u32(&f, first_rx_ms);
+    fmt_str(&f, hinted ? " (saved radio cal)\r\n" : " (probed)\r\n");
+    fmt_flush(&f);
 }
 
 void mesh_mini_init(void) {
+    const lora_region_t region = REGION_EU_868;
+    const lora_modem_preset_t preset = MODEM_LONG_FAST;
+    uint32_t stage_us[4];
+    uint32_t t;
+
+    t = boot_cycles();
     led_init();
     config_set_defaults(&g_config);
     config_load(&g_config);
+    stage_us[0] = boot_us(boot_cycles() - t);
+
+    /* Same radio setup as last boot: reuse its oscillator and image band */
+    t = boot_cycles();
+    uint32_t fingerprint = radio_boot_fingerprint(region, preset);
+    bool hinted = (g_config.radio_boot.fingerprint == fingerprint &&
+                   g_config.radio_boot.osc != RADIO_OSC_UNKNOWN);
+    if (hinted) {
+        radio_boot_info_t hint = {
+            .osc       = g_config.radio_boot.osc,
+            .image_cal = g_config.radio_boot.image_cal,
+        };
+        lora_set_boot_hint(&hint);
+    }
     lora_init();
-    lora_set_region_preset(REGION_EU_868, MODEM_LONG_FAST);
-    aes_set_channel_key(g_config.channel_psk);
+    uint32_t first_rx_ms = now_ms();
+    stage_us[1] = boot_us(boot_cycles() - t);
+
+    t = boot_cycles();
+    lora_set_tx_done_cb(on_tx_done);
+    tx_queue_init();
+    lora_set_region_preset(region, preset);
+    lora_params_t params;
+    lora_get_params(&params);
+    stage_us[2] = boot_us(boot_cycles() - t);
+
+    t = boot_cycles();
+    flood_set_modem(params.sf, params.bw_hz);
+    rng_mix(g_config.node_id ^ now_ms());
+    channel_table_build(g_config.channels, g_config.channel_count);
+    serial_api_init(&g_config, api_send);
+    serial_rx_init(&api_rx, serial_api_on_frame);
+    const config_channel_t *primary = channel_table_get(0);
+    if (primary && primary->psk_len && aes_set_channel_key(primary->psk, primary->psk_len))
+        active_channel = 0;
+    stage_us[3] = boot_us(boot_cycles() - t);
+
+    print_boot(stage_us, first_rx_ms, hinted);
+
+    /* Save what this boot found if it differs (once per board / region change) */
+    radio_boot_info_t info;
+    lora_get_boot_info(&info);
+    if (info.osc != RADIO_OSC_UNKNOWN &&
+        (g_config.radio_boot.fingerprint != fingerprint ||
+         g_config.radio_boot.osc != info.osc || g_config.radio_boot.image_cal != info.image_cal)) {
+        g_config.radio_boot.fingerprint = fingerprint;
+        g_config.radio_boot.osc = info.osc;
+        g_config.radio_boot.image_cal = info.image_cal;
+        config_save(&g_config);
+    }
 }
@@ -0,0 +1,65 @@
+/**
+ * Power state choice and per-state time accounting. Times are taken from
+ * the hw microsecond clock around each sleep; the stretch between two
+ * sleeps counts as RUN.
+ */
+
+#include "power.h"
+#include <stddef.h>
+
+static const power_hw_t *s_hw;
+static bool     s_stop = true;
+static uint32_t s_last_us;              /* end of the last sleep (start of RUN) */
+static uint64_t s_us[POWER_STATE_COUNT];
+static uint32_t s_entries[POWER_STATE_COUNT];
+
+void power_init(const power_hw_t *hw) {
+    s_hw = hw;
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        s_us[i] = 0;
+        s_entries[i] = 0;
+    }
+    s_last_us = hw ? hw->now_us() : 0;
+}
+
+void power_set_stop(bool enabled) {
+    s_stop = enabled;
+}
+
+power_state_t power_choose(uint32_t idle_ms, bool stop_blocked, bool stop_enabled,
+                           uint32_t *sleep_ms) {
+    *sleep_ms = 0;
+    /* A due timer (idle_ms 0) runs on the next SysTick, so WFI as well */
+    if (!stop_enabled || stop_blocked || idle_ms < POWER_STOP_MIN_MS)
+        return POWER_SLEEP;
+    *sleep_ms = idle_ms < POWER_STOP_MAX_MS ? idle_ms : POWER_STOP_MAX_MS;
+    return POWER_STOP;
+}
+
+void power_idle(uint32_t idle_ms) {
+    if (!s_hw) return;
+    uint32_t sleep_ms;
+    bool blocked = s_hw->stop_blocked && s_hw->stop_blocked();
+    power_state_t st = power_choose(idle_ms, blocked, s_stop, &sleep_ms);
+
+    uint32_t t0 = s_hw->now_us();
+    s_us[POWER_RUN] += t0 - s_last_us;
+    s_entries[POWER_RUN]++;
+    if (st == POWER_STOP)
+        s_hw->stop(sleep_ms);
+    else
+        s_hw->sleep();
+    s_last_us = s_hw->now_us();
+    s_us[st] += s_last_us - t0;
+    s_entries[st]++;
+}
+
+void power_get_stats(power_stats_t *out) {
+    if (!out) return;
+    uint32_t run_now = s_hw ? s_hw->now_us() - s_last_us : 0;
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        uint64_t us = s_us[i] + (i == POWER_RUN ? run_now : 0);
+        out->ms[i] = (uint32_t)(us / 1000u);
+        out->entries[i] = s_entries[i];
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * Low-power manager: between loop passes, picks how deep to sleep and keeps
+ * the time spent in each power state.
+ *   RUN   - the loop is working
+ *   SLEEP - WFI, clocks on; SysTick wakes the core every millisecond
+ *   STOP  - clocks off, the radio stays in RX; wakes on the SubGHz IRQ, a
+ *           received UART byte or the wake timer (LPTIM), then restores
+ *           48 MHz. STOP1 on the STM32WL (POWER_UART_WAKE), else STOP2.
+ * STOP is used only when no timer is due for POWER_STOP_MIN_MS and nothing
+ * that needs the clocks (UART DMA) is running. The decision and the
+ * accounting are HAL-free: the hardware comes in as power_hw_t, the STM32WL
+ * one (power_stm32wl_init) or a simulated clock (power_sim.h) on a host.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* idle_ms when no timer is pending */
+#define POWER_IDLE_FOREVER  0xFFFFFFFFu
+
+/* Shorter idle stretches sleep in WFI: wake-up and clock restore cost more */
+#ifndef POWER_STOP_MIN_MS
+#define POWER_STOP_MIN_MS  5u
+#endif
+
+/* Longest single STOP (wake timer range); the loop just sleeps again */
+#ifndef POWER_STOP_MAX_MS
+#define POWER_STOP_MAX_MS  30000u
+#endif
+
+/* After UART input, stay out of STOP this long: the rest of a command or
+ * frame (and the IDLE-line event that delivers it) is received in WFI,
+ * without a stop and wake-up per byte. */
+#ifndef POWER_UART_HOLD_MS
+#define POWER_UART_HOLD_MS  2000u
+#endif
+
+/* 1: STOP is STOP1, where USART1 runs on HSI and its received byte wakes the
+ * core, so no input is lost. 0: STOP2 (lower current), where USART1 is not
+ * clocked; input arriving then is lost, so only for nodes without a serial
+ * host. */
+#ifndef POWER_UART_WAKE
+#define POWER_UART_WAKE     1
+#endif
+
+typedef enum {
+    POWER_RUN,
+    POWER_SLEEP,
+    POWER_STOP,
+    POWER_STATE_COUNT
+} power_state_t;
+
+typedef struct {
+    uint32_t (*now_us)(void);           /* free-running, wraps; advanced across STOP */
+    bool     (*stop_blocked)(void);     /* something STOP would halt is running */
+    void     (*sleep)(void);            /* WFI */
+    void     (*stop)(uint32_t max_ms);  /* STOP until an interrupt or max_ms; clocks restored */
+} power_hw_t;
+
+typedef struct {
+    uint32_t ms[POWER_STATE_COUNT];         /* time in each state since power_init */
+    uint32_t entries[POWER_STATE_COUNT];    /* RUN: loop passes ended by power_idle */
+} power_stats_t;
+
+void power_init(const power_hw_t *hw);
+/* STOP on/off (off: always WFI, e.g. while a debugger is attached) */
+void power_set_stop(bool enabled);
+
+/* The decision alone: POWER_SLEEP or POWER_STOP, and for how long (ms,
+ * STOP only). */
+power_state_t power_choose(uint32_t idle_ms, bool stop_blocked, bool stop_enabled,
+                           uint32_t *sleep_ms);
+
+/* Sleep until an interrupt; idle_ms = time until the loop's next timer is
+ * due (POWER_IDLE_FOREVER = none). Call with interrupts masked and no event
+ * pending; returns awake, interrupts still masked. */
+void power_idle(uint32_t idle_ms);
+
+void power_get_stats(power_stats_t *out);
+
+#if defined(USE_HAL_DRIVER)
+/* LSI-clocked LPTIM1 wake timer, USART1 wake-from-stop; installs the hw. */
+void power_stm32wl_init(void);
+#else
+static inline void power_stm32wl_init(void) {}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_H */
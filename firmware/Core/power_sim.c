@@ -0,0 +1,60 @@
+/**
+ * Simulated power hardware (host builds).
+ */
+
+#include "power_sim.h"
+#include <string.h>
+
+static power_sim_t sim;
+
+static uint32_t sim_now_us(void) {
+    return sim.now_us;
+}
+
+static bool sim_stop_blocked(void) {
+    return sim.blocked;
+}
+
+/* Advance to `until`, or to the scripted interrupt if it comes first */
+static void sim_advance(uint32_t until) {
+    if (sim.irq_armed && (int32_t)(sim.irq_at_us - until) <= 0) {
+        if ((int32_t)(sim.irq_at_us - sim.now_us) > 0)
+            sim.now_us = sim.irq_at_us;
+        sim.irq_armed = false;
+        return;
+    }
+    sim.now_us = until;
+}
+
+static void sim_sleep(void) {
+    sim.sleeps++;
+    sim_advance((sim.now_us / 1000u + 1u) * 1000u);
+}
+
+static void sim_stop(uint32_t max_ms) {
+    sim.stops++;
+    sim_advance(sim.now_us + max_ms * 1000u);
+    sim.now_us += sim.wake_us;
+}
+
+static const power_hw_t sim_hw = {
+    .now_us       = sim_now_us,
+    .stop_blocked = sim_stop_blocked,
+    .sleep        = sim_sleep,
+    .stop         = sim_stop,
+};
+
+power_sim_t *power_sim_start(void) {
+    memset(&sim, 0, sizeof(sim));
+    power_init(&sim_hw);
+    return &sim;
+}
+
+void power_sim_irq_in(uint32_t in_us) {
+    sim.irq_armed = true;
+    sim.irq_at_us = sim.now_us + in_us;
+}
+
+void power_sim_run(uint32_t us) {
+    sim.now_us += us;
+}
@@ -0,0 +1,40 @@
+/**
+ * Simulated clock for the power manager on a host: sleeps advance a
+ * microsecond counter instead of stopping the core. SLEEP ends at the next
+ * 1 ms tick (SysTick) or a scripted interrupt, STOP at the wake timer or a
+ * scripted interrupt, plus the wake-up time.
+ */
+
+#ifndef POWER_SIM_H
+#define POWER_SIM_H
+
+#include "power.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t now_us;
+    bool     irq_armed;     /* an interrupt fires at irq_at_us */
+    uint32_t irq_at_us;
+    bool     blocked;       /* stop_blocked() answer */
+    uint32_t wake_us;       /* STOP exit + clock restore, charged to STOP */
+    uint32_t sleeps;        /* hw->sleep() calls */
+    uint32_t stops;         /* hw->stop() calls */
+} power_sim_t;
+
+/* Reset the simulated clock to zero and install it (power_init). */
+power_sim_t *power_sim_start(void);
+
+/* Interrupt at now + in_us (radio packet, UART byte); wakes either sleep. */
+void power_sim_irq_in(uint32_t in_us);
+
+/* Time spent awake (loop work). */
+void power_sim_run(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_SIM_H */
@@ -0,0 +1,148 @@
+/**
+ * STM32WL hardware for the power manager. STOP wake sources:
+ *   SubGHz radio IRQ (EXTI 44, enabled by the radio driver),
+ *   LPTIM1 one-shot on LSI / 16 (2 kHz; LSI needs no start-up wait, unlike
+ *   the LSE crystal, and a few % error only stretches timer slots),
+ *   USART1 receive (EXTI 26, POWER_UART_WAKE): USART1 can wake the core
+ *   from STOP0/1 only, not STOP2, so STOP is entered as STOP1 with the
+ *   USART on its HSI kernel clock; the byte that wakes the core is received
+ *   whole (serial_stop_enter/exit).
+ * On wake the 48 MHz MSI clock is set up again (SystemClock_Config_LL) and
+ * the HAL tick is advanced by the time counted on LPTIM1.
+ */
+#if defined(USE_HAL_DRIVER)
+
+#include "power.h"
+#include "event.h"
+#include "serial_io.h"
+#include "stm32wlxx_hal.h"
+#include "stm32wlxx_ll_bus.h"
+#include "stm32wlxx_ll_exti.h"
+#include "stm32wlxx_ll_lptim.h"
+#include "stm32wlxx_ll_rcc.h"
+
+#define LPTIM_HZ        2000u               /* LSI 32 kHz / 16 */
+#define LPTIM_MAX_MS    (0xFFFFu * 1000u / LPTIM_HZ)
+#define UART_WAKE_LINE  LL_EXTI_LINE_26     /* USART1 wake-up */
+
+extern void SystemClock_Config_LL(void);
+
+static uint32_t lptim_frac;                 /* ticks * 1000 not yet added to the HAL tick */
+static uint32_t rx_seen;                    /* received + wakeups at the last check */
+static uint32_t rx_active_ms;               /* time UART input was last seen */
+
+/* HAL tick + SysTick position; a wrap not yet served by SysTick_Handler
+ * (interrupts masked) shows as the pending bit. */
+static uint32_t hw_now_us(void) {
+    uint32_t ms = HAL_GetTick();
+    uint32_t load = SysTick->LOAD + 1u;
+    uint32_t val = SysTick->VAL;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        ms++;
+        val = SysTick->VAL;
+    }
+    return ms * 1000u + (uint32_t)((uint64_t)(load - val) * 1000u / load);
+}
+
+/* STOP halts the DMA (TX ring not yet sent); input in progress is finished
+ * in WFI (POWER_UART_HOLD_MS) */
+static bool hw_stop_blocked(void) {
+    serial_tx_stats_t ts;
+    serial_get_tx_stats(&ts);
+    if (ts.pending) return true;
+    serial_rx_stats_t rs;
+    serial_get_rx_stats(&rs);
+    uint32_t now = HAL_GetTick();
+    if (rs.received + rs.wakeups != rx_seen) {
+        rx_seen = rs.received + rs.wakeups;
+        rx_active_ms = now;
+    }
+    return now - rx_active_ms < POWER_UART_HOLD_MS;
+}
+
+static void hw_sleep(void) {
+    __DSB();
+    __WFI();
+}
+
+static void hw_stop(uint32_t max_ms) {
+    if (max_ms > LPTIM_MAX_MS) max_ms = LPTIM_MAX_MS;
+    uint32_t arr = max_ms * LPTIM_HZ / 1000u;
+
+    LL_LPTIM_Enable(LPTIM1);
+    LL_LPTIM_ClearFlag_ARROK(LPTIM1);
+    LL_LPTIM_SetAutoReload(LPTIM1, arr);
+    while (!LL_LPTIM_IsActiveFlag_ARROK(LPTIM1)) {}
+    LL_LPTIM_StartCounter(LPTIM1, LL_LPTIM_OPERATING_MODE_ONESHOT);
+
+    HAL_SuspendTick();
+#if POWER_UART_WAKE
+    serial_stop_enter();
+    HAL_PWREx_EnterSTOP1Mode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+    SystemClock_Config_LL();
+    serial_stop_exit();
+#else
+    HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
+    SystemClock_Config_LL();
+#endif
+    HAL_ResumeTick();
+
+    /* CNT is clocked asynchronously: read until two reads agree */
+    uint32_t ticks;
+    if (LL_LPTIM_IsActiveFlag_ARRM(LPTIM1)) {
+        ticks = arr;
+    } else {
+        uint32_t c;
+        do {
+            c = LL_LPTIM_GetCounter(LPTIM1);
+            ticks = LL_LPTIM_GetCounter(LPTIM1);
+        } while (c != ticks);
+    }
+    LL_LPTIM_Disable(LPTIM1);
+
+    uint32_t t = ticks * 1000u + lptim_frac;
+    uwTick += t / LPTIM_HZ;
+    lptim_frac = t % LPTIM_HZ;
+}
+
+static const power_hw_t stm32wl_hw = {
+    .now_us       = hw_now_us,
+    .stop_blocked = hw_stop_blocked,
+    .sleep        = hw_sleep,
+    .stop         = hw_stop,
+};
+
+void power_stm32wl_init(void) {
+    LL_RCC_LSI_Enable();
+    while (!LL_RCC_LSI_IsReady()) {}
+    LL_RCC_SetLPTIMClockSource(LL_RCC_LPTIM1_CLKSOURCE_LSI);
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_LPTIM1);
+
+    /* IER is written only while the timer is disabled */
+    LL_LPTIM_Disable(LPTIM1);
+    LL_LPTIM_SetClockSource(LPTIM1, LL_LPTIM_CLK_SOURCE_INTERNAL);
+    LL_LPTIM_SetPrescaler(LPTIM1, LL_LPTIM_PRESCALER_DIV16);
+    LL_LPTIM_SetCounterMode(LPTIM1, LL_LPTIM_COUNTER_MODE_INTERNAL);
+    LL_LPTIM_EnableIT_ARRM(LPTIM1);
+    LL_EXTI_EnableIT_0_31(LL_EXTI_LINE_29);                 /* LPTIM1 wake-up */
+    HAL_NVIC_SetPriority(LPTIM1_IRQn, 3, 0);
+    HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+
+#if POWER_UART_WAKE
+    /* Direct line: the USART's WUF interrupt (serial_init) wakes the core */
+    LL_EXTI_EnableIT_0_31(UART_WAKE_LINE);
+#endif
+
+    rx_active_ms = HAL_GetTick();
+    power_init(&stm32wl_hw);
+}
+
+/* Wake timer expired: the loop's timers are due */
+void LPTIM1_IRQHandler(void) {
+    if (LL_LPTIM_IsActiveFlag_ARRM(LPTIM1)) {
+        LL_LPTIM_ClearFlag_ARRM(LPTIM1);
+        event_post(EVENT_TICK);
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * Stage statistics for profile.h. A record is a few adds and compares under
+ * a short PRIMASK section, so interrupt stages (RX restart) and `stats`
+ * see consistent entries.
+ */
+
+#include "profile.h"
+
+#if MESH_PROFILE
+
+#if defined(USE_HAL_DRIVER)
+#include "stm32wlxx_hal.h"
+#else
+#include <time.h>
+#endif
+#include <string.h>
+
+static prof_stat_t stats[PROF_STAGE_COUNT];
+
+static const char *const stage_names[PROF_STAGE_COUNT] = {
+    [PROF_LOOP]       = "loop pass",
+    [PROF_HDR_PARSE]  = "header parse",
+    [PROF_DEDUP]      = "dedup",
+    [PROF_AES_CTR]    = "AES-CTR",
+    [PROF_PB_DECODE]  = "protobuf decode",
+    [PROF_UART_OUT]   = "UART output",
+    [PROF_TX]         = "TX start",
+    [PROF_RX_RESTART] = "RX restart",
+};
+
+uint32_t prof_now(void) {
+#if defined(USE_HAL_DRIVER)
+    return DWT->CYCCNT;     /* enabled by cyccnt_init at boot */
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint32_t)ts.tv_sec * 1000000000u + (uint32_t)ts.tv_nsec;
+#endif
+}
+
+const char *prof_unit(void) {
+#if defined(USE_HAL_DRIVER)
+    return "cyc";
+#else
+    return "ns";
+#endif
+}
+
+const char *prof_stage_name(prof_stage_t stage) {
+    return stage < PROF_STAGE_COUNT ? stage_names[stage] : "?";
+}
+
+void prof_record(prof_stage_t stage, uint32_t ticks) {
+    if (stage >= PROF_STAGE_COUNT) return;
+#if defined(USE_HAL_DRIVER)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+#endif
+    prof_stat_t *s = &stats[stage];
+    if (s->count == 0 || ticks < s->min) s->min = ticks;
+    if (ticks > s->max) s->max = ticks;
+    s->sum += ticks;
+    s->count++;
+#if defined(USE_HAL_DRIVER)
+    __set_PRIMASK(primask);
+#endif
+}
+
+void prof_take(prof_stat_t out[PROF_STAGE_COUNT]) {
+#if defined(USE_HAL_DRIVER)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+#endif
+    memcpy(out, stats, sizeof(stats));
+    memset(stats, 0, sizeof(stats));
+#if defined(USE_HAL_DRIVER)
+    __set_PRIMASK(primask);
+#endif
+}
+
+#endif /* MESH_PROFILE */
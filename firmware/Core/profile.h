@@ -0,0 +1,69 @@
+/**
+ * Hot-path stage profiling on the DWT cycle counter (nanoseconds from the
+ * C11 clock on a host). Built only with MESH_PROFILE=1 (CMake option
+ * MESH_PROFILE); otherwise PROF_BEGIN / PROF_END expand to nothing and no
+ * profiling code or data is linked. `stats` prints count and min/avg/max per
+ * stage, then resets them.
+ *
+ *   PROF_BEGIN(t);
+ *   ...stage...
+ *   PROF_END(PROF_AES_CTR, t);
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MESH_PROFILE
+#define MESH_PROFILE 0
+#endif
+
+typedef enum {
+    PROF_LOOP,          /* one mesh_mini_loop() pass */
+    PROF_HDR_PARSE,     /* 16-byte LoRa header */
+    PROF_DEDUP,         /* flood_check_and_insert */
+    PROF_AES_CTR,       /* channel key + CTR over the payload */
+    PROF_PB_DECODE,     /* Data protobuf */
+    PROF_UART_OUT,      /* received packet to the serial port */
+    PROF_TX,            /* frame handed to the radio (CAD or SetTx issued) */
+    PROF_RX_RESTART,    /* SetRx after RxDone, in the radio IRQ */
+    PROF_STAGE_COUNT
+} prof_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} prof_stat_t;
+
+#if MESH_PROFILE
+
+uint32_t prof_now(void);
+/* Any context, including interrupts. */
+void prof_record(prof_stage_t stage, uint32_t ticks);
+/* Copy every stage and reset them, as one snapshot. */
+void prof_take(prof_stat_t out[PROF_STAGE_COUNT]);
+const char *prof_stage_name(prof_stage_t stage);
+const char *prof_unit(void);    /* "cyc" or "ns" */
+
+#define PROF_BEGIN(t)       uint32_t t = prof_now()
+#define PROF_END(stage, t)  prof_record((stage), prof_now() - (t))
+
+#else
+
+#define PROF_BEGIN(t)       do { } while (0)
+#define PROF_END(stage, t)  do { } while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILE_H */
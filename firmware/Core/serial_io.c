@@ -1,44 +1,49 @@
 /**
  * Main serial: USART1 on PB6 (TX), PB7 (RX), 115200 8N1.
  * Used for all exchange with the device (commands, LoRa payloads, RX print).
+ * TX is non-blocking: writers copy into a ring that DMA1 channel 1 drains one
+ * contiguous chunk at a time; the next chunk is started from the completion
+ * callback.
+ * RX: DMA1 channel 2 writes into a circular buffer that is itself the RX
+ * ring. Half/full-transfer and IDLE-line events only advance the head, so
+ * there is no per-byte interrupt; the reader detects a lapped buffer.
  */
 #if defined(USE_HAL_DRIVER)
 
 #include <stdbool.h>
 #include "stm32wlxx_hal.h"
 #include "stm32wlxx_hal_gpio_ex.h"
+#include "serial_io.h"
+#include "byte_ring.h"
+#include "event.h"
 
 static UART_HandleTypeDef huart1;
+static DMA_HandleTypeDef hdma_usart1_tx;
+static DMA_HandleTypeDef hdma_usart1_rx;
 
-#define RX_RING_SIZE 256
-static volatile uint8_t rx_ring[RX_RING_SIZE];
-static volatile uint16_t rx_head;
-static volatile uint16_t rx_tail;
+static uint8_t tx_buf[SERIAL_TX_RING_SIZE];
+static byte_ring_t tx_ring;
+static volatile uint16_t tx_inflight;   /* bytes owned by the running DMA transfer */
+static volatile uint32_t tx_dma_dropped; /* bytes lost with an aborted transfer */
 
-void serial_push_byte(uint8_t b) {
-    uint16_t next = (rx_head + 1) % RX_RING_SIZE;
-    if (next != rx_tail) {
-        rx_ring[rx_head] = b;
-        rx_head = next;
-    }
-}
-
-bool serial_get_byte(uint8_t *out) {
-    if (out == NULL) return false;
-    if (rx_tail == rx_head) return false;
-    *out = rx_ring[rx_tail];
-    rx_tail = (rx_tail + 1) % RX_RING_SIZE;
-    return true;
-}
+static uint8_t rx_dma_buf[SERIAL_RX_DMA_SIZE];
+static byte_ring_t rx_ring;             /* over rx_dma_buf; head advanced by RX events */
+static volatile uint16_t rx_dma_pos;    /* DMA write position at the last event */
+static volatile bool rx_restart;        /* RX DMA stopped by a line error */
+static serial_rx_stats_t rx_stats;
 
 void HAL_UART_MspInit(UART_HandleTypeDef *huart)
 {
     if (huart->Instance != USART1)
         return;
 
+    /* HSI kernel clock: in STOP1 the USART can request it and receive the
+     * byte that wakes the core (PCLK2 is stopped there) */
+    __HAL_RCC_HSI_ENABLE();
+    while (!__HAL_RCC_GET_FLAG(RCC_FLAG_HSIRDY)) {}
     RCC_PeriphCLKInitTypeDef PeriphClkInit = {0};
     PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_USART1;
-    PeriphClkInit.Usart1ClockSelection = RCC_USART1CLKSOURCE_PCLK2;
+    PeriphClkInit.Usart1ClockSelection = RCC_USART1CLKSOURCE_HSI;
     HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit);
 
     __HAL_RCC_USART1_CLK_ENABLE();
@@ -51,6 +56,194 @@ void HAL_UART_MspInit(UART_HandleTypeDef *huart)
     g.Speed     = GPIO_SPEED_FREQ_LOW;
     g.Alternate = GPIO_AF7_USART1;
     HAL_GPIO_Init(GPIOB, &g);
+
+    __HAL_RCC_DMAMUX1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_usart1_tx.Instance                 = DMA1_Channel1;
+    hdma_usart1_tx.Init.Request             = DMA_REQUEST_USART1_TX;
+    hdma_usart1_tx.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+    hdma_usart1_tx.Init.PeriphInc           = DMA_PINC_DISABLE;
+    hdma_usart1_tx.Init.MemInc              = DMA_MINC_ENABLE;
+    hdma_usart1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart1_tx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+    hdma_usart1_tx.Init.Mode                = DMA_NORMAL;
+    hdma_usart1_tx.Init.Priority            = DMA_PRIORITY_LOW;
+    if (HAL_DMA_Init(&hdma_usart1_tx) == HAL_OK)
+        __HAL_LINKDMA(huart, hdmatx, hdma_usart1_tx);
+    NVIC_SetPriority(DMA1_Channel1_IRQn, 2);
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+    hdma_usart1_rx.Instance                 = DMA1_Channel2;
+    hdma_usart1_rx.Init.Request             = DMA_REQUEST_USART1_RX;
+    hdma_usart1_rx.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+    hdma_usart1_rx.Init.PeriphInc           = DMA_PINC_DISABLE;
+    hdma_usart1_rx.Init.MemInc              = DMA_MINC_ENABLE;
+    hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.Mode                = DMA_CIRCULAR;
+    hdma_usart1_rx.Init.Priority            = DMA_PRIORITY_LOW;
+    if (HAL_DMA_Init(&hdma_usart1_rx) == HAL_OK)
+        __HAL_LINKDMA(huart, hdmarx, hdma_usart1_rx);
+    NVIC_SetPriority(DMA1_Channel2_IRQn, 2);
+    NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+}
+
+/* (Re)start circular reception at the start of the buffer. Anything unread
+ * is gone; called with the USART1/DMA RX IRQs excluded. */
+static void rx_start(void)
+{
+    rx_ring.head = 0;
+    rx_ring.tail = 0;
+    rx_dma_pos = 0;
+    rx_restart = (HAL_UARTEx_ReceiveToIdle_DMA(&huart1, rx_dma_buf, sizeof(rx_dma_buf)) != HAL_OK);
+}
+
+/* Half transfer, transfer complete or IDLE line: size is the DMA write
+ * position (1..SERIAL_RX_DMA_SIZE). HT/TC bound the gap between events to
+ * half the buffer, so the distance from the last position is unambiguous. */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t size)
+{
+    if (huart->Instance != USART1) return;
+    uint16_t pos = (uint16_t)(size & (SERIAL_RX_DMA_SIZE - 1));
+    uint16_t n = (uint16_t)((pos - rx_dma_pos) & (SERIAL_RX_DMA_SIZE - 1));
+    rx_dma_pos = pos;
+    rx_ring.head = (uint16_t)(rx_ring.head + n);
+    rx_stats.received += n;
+    event_post(EVENT_UART_RX);
+}
+
+/* Hand the next contiguous chunk to the DMA if it is idle. Runs with the
+ * USART1/DMA IRQs excluded (masked, or from their own handlers). Without a
+ * DMA channel the chunk is sent blocking. */
+static void tx_kick(void)
+{
+    if (tx_inflight) return;
+    const uint8_t *p;
+    uint16_t n = byte_ring_peek(&tx_ring, &p);
+    if (n == 0) return;
+    if (huart1.hdmatx == NULL) {
+        (void)HAL_UART_Transmit(&huart1, p, n, 100);
+        byte_ring_consume(&tx_ring, n);
+        return;
+    }
+    if (HAL_UART_Transmit_DMA(&huart1, p, n) == HAL_OK)
+        tx_inflight = n;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART1) return;
+    byte_ring_consume(&tx_ring, tx_inflight);
+    tx_inflight = 0;
+    tx_kick();
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART1) return;
+    /* Line errors are cleared in serial_uart_irq(); one that slips past (or
+     * a DMA error) aborts the circular RX DMA: the main loop restarts it on
+     * its next read. */
+    if (huart->RxState == HAL_UART_STATE_READY && !rx_restart) {
+        rx_stats.errors++;
+        rx_restart = true;
+        event_post(EVENT_UART_RX);
+    }
+    /* A DMA error ends the transfer without TxCplt: release the chunk
+     * (its bytes are lost) so output does not stall behind it. */
+    if (!tx_inflight || huart->gState != HAL_UART_STATE_READY)
+        return;
+    tx_dma_dropped += tx_inflight;
+    byte_ring_consume(&tx_ring, tx_inflight);
+    tx_inflight = 0;
+    tx_kick();
+}
+
+/* WUF: a byte received in STOP1 woke the core. It is held in RDR until
+ * serial_stop_exit() lets the DMA take it. */
+void HAL_UARTEx_WakeupCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART1) return;
+    rx_stats.wakeups++;
+    event_post(EVENT_UART_RX);
+}
+
+/* DMA requests are not served in STOP: with DMAR cleared the byte stays in
+ * RDR, and UESM lets the USART run on HSI to receive it (RXNE -> WUF). */
+void serial_stop_enter(void)
+{
+    if (huart1.Instance == NULL) return;
+    CLEAR_BIT(huart1.Instance->CR3, USART_CR3_DMAR);
+    (void)HAL_UARTEx_EnableStopMode(&huart1);
+}
+
+/* Right after the clock restore: the next byte is at most 87 us away */
+void serial_stop_exit(void)
+{
+    if (huart1.Instance == NULL) return;
+    /* HSION is cleared by STOP entry; the USART kernel clock needs it */
+    __HAL_RCC_HSI_ENABLE();
+    while (!__HAL_RCC_GET_FLAG(RCC_FLAG_HSIRDY)) {}
+    (void)HAL_UARTEx_DisableStopMode(&huart1);
+    SET_BIT(huart1.Instance->CR3, USART_CR3_DMAR);
+}
+
+void DMA1_Channel1_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart1_tx);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart1_rx);
+}
+
+/* Overrun/framing/noise/parity are cleared and counted before the HAL
+ * handler sees them: HAL would end the reception (UART_EndRxTransfer clears
+ * the RX interrupt enables and aborts the DMA) for what is one lost byte. */
+void serial_uart_irq(void)
+{
+    const uint32_t line_err = USART_ISR_ORE | USART_ISR_FE | USART_ISR_NE | USART_ISR_PE;
+    if (huart1.Instance->ISR & line_err) {
+        __HAL_UART_CLEAR_FLAG(&huart1, UART_CLEAR_OREF | UART_CLEAR_FEF |
+                                       UART_CLEAR_NEF | UART_CLEAR_PEF);
+        rx_stats.errors++;
+    }
+    HAL_UART_IRQHandler(&huart1);
+}
+
+uint16_t serial_tx_room(void)
+{
+    return huart1.Instance ? byte_ring_free(&tx_ring) : 0;
+}
+
+/* Copy into the TX ring without starting the DMA; the caller checked room. */
+void serial_tx_put(const uint8_t *data, uint16_t len)
+{
+    (void)byte_ring_write(&tx_ring, data, len);
+}
+
+void serial_tx_start(void)
+{
+    if (huart1.Instance == NULL) return;
+    HAL_NVIC_DisableIRQ(USART1_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+    tx_kick();
+    HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+    HAL_NVIC_EnableIRQ(USART1_IRQn);
+}
+
+/* Copy into the TX ring (never waits) and start the DMA if idle. whole:
+ * all-or-nothing, for binary frames that must not be cut. */
+static void tx_enqueue(const uint8_t *data, uint16_t len, bool whole)
+{
+    if (huart1.Instance == NULL || len == 0) return;
+    if (whole) {
+        if (!byte_ring_write_all(&tx_ring, data, len)) return;
+    } else {
+        (void)byte_ring_write(&tx_ring, data, len);
+    }
+    serial_tx_start();
 }
 
 void serial_init(void)
@@ -67,60 +260,119 @@ void serial_init(void)
     huart1.Init.ClockPrescaler = UART_PRESCALER_DIV1;
     huart1.AdvancedInit.AdvFeatureInit = UART_ADVFEATURE_NO_INIT;
 
-    if (HAL_UART_Init(&huart1) != HAL_OK)
+    byte_ring_init(&tx_ring, tx_buf, sizeof(tx_buf));
+    byte_ring_init(&rx_ring, rx_dma_buf, sizeof(rx_dma_buf));
+    if (HAL_UART_Init(&huart1) != HAL_OK) {
+        huart1.Instance = NULL;
         return;
+    }
+
+    /* Wake from STOP on a whole received byte, not the start bit */
+    UART_WakeUpTypeDef wake = { .WakeUpEvent = UART_WAKEUP_ON_READDATA_NONEMPTY };
+    (void)HAL_UARTEx_StopModeWakeUpSourceConfig(&huart1, wake);
+    __HAL_UART_ENABLE_IT(&huart1, UART_IT_WUF);
 
-    __HAL_UART_ENABLE_IT(&huart1, UART_IT_RXNE);
     NVIC_SetPriority(USART1_IRQn, 2);
     NVIC_EnableIRQ(USART1_IRQn);
+    rx_start();
+}
+
+uint16_t serial_rx_peek(const uint8_t **data)
+{
+    if (huart1.Instance == NULL) return 0;
+    if (rx_restart) {
+        rx_stats.dropped += byte_ring_used(&rx_ring);
+        HAL_NVIC_DisableIRQ(USART1_IRQn);
+        HAL_NVIC_DisableIRQ(DMA1_Channel2_IRQn);
+        rx_start();
+        HAL_NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+        HAL_NVIC_EnableIRQ(USART1_IRQn);
+    }
+    uint16_t used = byte_ring_used(&rx_ring);
+    if (used > SERIAL_RX_DMA_SIZE) {
+        /* DMA lapped the reader: the oldest bytes were overwritten */
+        rx_stats.overruns++;
+        rx_stats.dropped += used;
+        byte_ring_consume(&rx_ring, used);
+        return 0;
+    }
+    return byte_ring_peek(&rx_ring, data);
+}
+
+void serial_rx_consume(uint16_t n)
+{
+    byte_ring_consume(&rx_ring, n);
+}
+
+bool serial_get_byte(uint8_t *out)
+{
+    const uint8_t *p;
+    if (out == NULL || serial_rx_peek(&p) == 0) return false;
+    *out = *p;
+    serial_rx_consume(1);
+    return true;
+}
+
+void serial_get_rx_stats(serial_rx_stats_t *out)
+{
+    if (!out) return;
+    *out = rx_stats;
+    out->pending = byte_ring_used(&rx_ring);
 }
 
 void serial_puts(const char *s)
 {
-    if (s == NULL || huart1.Instance == NULL)
+    if (s == NULL)
         return;
     uint16_t n = 0;
-    while (s[n] != '\0' && n < 256)
+    while (s[n] != '\0' && n < SERIAL_TX_RING_SIZE)
         n++;
-    if (n > 0)
-        (void)HAL_UART_Transmit(&huart1, (const uint8_t *)s, n, 100);
+    tx_enqueue((const uint8_t *)s, n, SERIAL_TX_DROP_WHOLE);
 }
 
 void serial_write(const uint8_t *data, uint16_t len)
 {
-    if (data == NULL || huart1.Instance == NULL || len == 0)
+    if (data == NULL)
         return;
-    (void)HAL_UART_Transmit(&huart1, data, len, 100);
+    tx_enqueue(data, len, SERIAL_TX_DROP_WHOLE);
 }
 
-void serial_put_int16(int16_t v)
+void uart_tx(const uint8_t *data, uint16_t len)
+{
+    if (data == NULL)
+        return;
+    tx_enqueue(data, len, true);
+}
+
+void serial_flush(void)
 {
     if (huart1.Instance == NULL) return;
-    uint8_t buf[8];
-    uint8_t n = 0;
-    uint16_t u;
-    if (v < 0) {
-        buf[n++] = '-';
-        u = (uint16_t)(-(int32_t)v);
-    } else {
-        u = (uint16_t)v;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (tx_inflight) {
+        /* Keep what the DMA already sent, resend the rest by polling */
+        uint16_t left = (uint16_t)__HAL_DMA_GET_COUNTER(&hdma_usart1_tx);
+        (void)HAL_UART_AbortTransmit(&huart1);
+        byte_ring_consume(&tx_ring, (uint16_t)(tx_inflight - left));
+        tx_inflight = 0;
     }
-    if (u == 0) {
-        buf[n++] = '0';
-    } else {
-        uint8_t digits[5];
-        uint8_t d = 0;
-        while (u) { digits[d++] = (uint8_t)(u % 10u); u /= 10u; }
-        while (d) buf[n++] = (uint8_t)('0' + digits[--d]);
+    const uint8_t *p;
+    uint16_t n;
+    while ((n = byte_ring_peek(&tx_ring, &p)) != 0) {
+        (void)HAL_UART_Transmit(&huart1, p, n, 100);
+        byte_ring_consume(&tx_ring, n);
     }
-    (void)HAL_UART_Transmit(&huart1, buf, n, 100);
+    __set_PRIMASK(primask);
 }
 
-void uart_tx(const uint8_t *data, uint16_t len)
+void serial_get_tx_stats(serial_tx_stats_t *out)
 {
-    if (data == NULL || huart1.Instance == NULL)
-        return;
-    (void)HAL_UART_Transmit(&huart1, data, len, 500);
+    if (!out) return;
+    out->queued = tx_ring.stats.written;
+    out->dropped = tx_ring.stats.dropped + tx_dma_dropped;
+    out->overflows = tx_ring.stats.overflows;
+    out->pending = byte_ring_used(&tx_ring);
+    out->high_water = tx_ring.stats.high_water;
 }
 
 #endif
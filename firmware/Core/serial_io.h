@@ -1,6 +1,12 @@
 /**
  * Main serial (USART1): all application exchange with the device.
  * PB6 (TX), PB7 (RX), 115200 8N1.
+ * Output is queued in a TX ring and sent by DMA; the write calls never wait.
+ * When the ring is full, text writes keep what fits (or drop whole with
+ * SERIAL_TX_DROP_WHOLE=1); uart_tx() is always all-or-nothing. Formatted
+ * output: build the line with fmt.h and send it in one write.
+ * Input is received by circular DMA (IDLE line + half/full transfer events)
+ * and read in place as contiguous spans.
  */
 #ifndef SERIAL_IO_H
 #define SERIAL_IO_H
@@ -8,23 +14,83 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/* Power of two; 1024 B = ~90 ms of output at 115200 */
+#ifndef SERIAL_TX_RING_SIZE
+#define SERIAL_TX_RING_SIZE  1024
+#endif
+
+#ifndef SERIAL_TX_DROP_WHOLE
+#define SERIAL_TX_DROP_WHOLE  0
+#endif
+
+/* Power of two; must hold the input arriving between two main-loop reads */
+#ifndef SERIAL_RX_DMA_SIZE
+#define SERIAL_RX_DMA_SIZE  256
+#endif
+
+typedef struct {
+    uint32_t queued;       /* bytes accepted */
+    uint32_t dropped;      /* bytes lost to a full ring (or a DMA error) */
+    uint32_t overflows;    /* writes that did not fit */
+    uint16_t pending;      /* bytes waiting now */
+    uint16_t high_water;
+} serial_tx_stats_t;
+
+typedef struct {
+    uint32_t received;     /* bytes written by the DMA */
+    uint32_t overruns;     /* times the DMA lapped the reader */
+    uint32_t errors;       /* UART line errors (overrun, framing, noise) */
+    uint32_t dropped;      /* unread bytes discarded by either */
+    uint32_t wakeups;      /* core woken from STOP by a received byte */
+    uint16_t pending;
+} serial_rx_stats_t;
+
 #if defined(USE_HAL_DRIVER)
 
 void serial_init(void);
 void serial_puts(const char *s);
 void serial_write(const uint8_t *data, uint16_t len);
-void serial_put_int16(int16_t v);   /* decimal to UART (for RSSI, etc.) */
-void serial_push_byte(uint8_t b);   /* from USART1 IRQ when RXNE */
 bool serial_get_byte(uint8_t *out); /* non-blocking */
+/* Longest contiguous span of received bytes, read in place (0 = none);
+ * release it with serial_rx_consume(). */
+uint16_t serial_rx_peek(const uint8_t **data);
+void serial_rx_consume(uint16_t n);
+void serial_uart_irq(void);         /* from USART1_IRQHandler: IDLE, TX complete, errors */
+/* Piecewise output (binary frames): check room, put the pieces, then start.
+ * serial_tx_put() never waits; what does not fit is counted as dropped. */
+uint16_t serial_tx_room(void);
+void serial_tx_put(const uint8_t *data, uint16_t len);
+void serial_tx_start(void);
+/* Send everything queued by polling, IRQs masked; for fault/reset paths. */
+void serial_flush(void);
+void serial_get_tx_stats(serial_tx_stats_t *out);
+void serial_get_rx_stats(serial_rx_stats_t *out);
+/* Around STOP1 (power_stm32wl.c): RX DMA paused, USART1 left to receive on
+ * HSI so the byte that wakes the core is kept; exit restores both. */
+void serial_stop_enter(void);
+void serial_stop_exit(void);
 
 #else
 
 static inline void serial_init(void) {}
 static inline void serial_puts(const char *s) { (void)s; }
 static inline void serial_write(const uint8_t *data, uint16_t len) { (void)data; (void)len; }
-static inline void serial_put_int16(int16_t v) { (void)v; }
-static inline void serial_push_byte(uint8_t b) { (void)b; }
 static inline bool serial_get_byte(uint8_t *out) { (void)out; return false; }
+static inline uint16_t serial_rx_peek(const uint8_t **data) { (void)data; return 0; }
+static inline void serial_rx_consume(uint16_t n) { (void)n; }
+static inline void serial_uart_irq(void) {}
+static inline uint16_t serial_tx_room(void) { return 0; }
+static inline void serial_tx_put(const uint8_t *data, uint16_t len) { (void)data; (void)len; }
+static inline void serial_tx_start(void) {}
+static inline void serial_flush(void) {}
+static inline void serial_get_tx_stats(serial_tx_stats_t *out) {
+    if (out) *out = (serial_tx_stats_t){0};
+}
+static inline void serial_get_rx_stats(serial_rx_stats_t *out) {
+    if (out) *out = (serial_rx_stats_t){0};
+}
+static inline void serial_stop_enter(void) {}
+static inline void serial_stop_exit(void) {}
 
 #endif
 
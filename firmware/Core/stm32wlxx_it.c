@@ -1,20 +1,20 @@
 /**
  * Minimal interrupt handlers for STM32WL (ARM + HAL build).
- * SysTick: only HAL tick. LED blink is done in main loop (led_tick).
- * USART1: push RX byte to main serial ring buffer.
+ * SysTick: HAL tick + EVENT_TICK once the main loop's next deadline is due.
+ * USART1: HAL handler (RX IDLE events, TX-DMA completion, error flags);
+ * the bytes themselves arrive by DMA.
  */
 #if defined(USE_HAL_DRIVER)
 #include "stm32wlxx_hal.h"
 #include "serial_io.h"
+#include "event.h"
 
 void SysTick_Handler(void) {
     HAL_IncTick();
+    event_systick(HAL_GetTick());
 }
 
 void USART1_IRQHandler(void) {
-    if (USART1->ISR & USART_ISR_RXNE_RXFNE) {
-        uint8_t b = (uint8_t)(USART1->RDR & 0xFF);
-        serial_push_byte(b);
-    }
+    serial_uart_irq();
 }
 #endif
@@ -1,5 +1,5 @@
 /**
- * System clock 48 MHz via MSI, using ST LL (no HAL).
+ * System clock 48 MHz via MSI, using ST LL (no HAL); DWT cycle counter.
  * Call before HAL_Init() so SysTick is configured for 48 MHz.
  */
 #if defined(USE_HAL_DRIVER)
@@ -43,4 +43,12 @@ void SystemClock_Config_LL(void)
     SystemCoreClockUpdate();
 }
 
+/* DWT cycle counter, used for boot timing, RX restart latency, busy time
+ * and stage profiling. Enabled once at boot, before any of them. */
+void cyccnt_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 #endif
@@ -1,7 +1,14 @@
 /**
- * AES-128-CTR for Meshtastic payloads via STM32WLE5 hardware AES.
+ * AES-128/256-CTR for Meshtastic payloads.
  *
- * CTR mode: AES-ECB encrypts the nonce to produce keystream, XOR with data.
+ * Backends: STM32WLE5 hardware AES (default with the HAL), or the portable
+ * software AES in aes_soft.c (MESH_AES_SOFT=1, and always on builds without
+ * the HAL, so host builds encrypt for real).
+ * Hardware CTR mode: by default the peripheral runs AES-CTR natively over the whole
+ * payload (MESH_AES_HW_CTR). With MESH_AES_HW_CTR=0 the original path is used:
+ * AES-ECB encrypts the nonce block by block and the keystream is XORed in software.
+ * Both are built with the peripheral so aes_hw_cycles() can time one against
+ * the other.
  * Nonce layout (16 bytes, matches Meshtastic CryptoEngine::initNonce):
  *   [0..3]   packetId    (LE 32-bit, low half of 64-bit packetId)
  *   [4..7]   0           (high half, always 0 for 32-bit IDs)
@@ -16,14 +23,24 @@
 #include "stm32wlxx_hal.h"
 #endif
 
-static uint8_t channel_key[MESH_AES_KEY_LEN];
+#if !MESH_AES_SOFT && defined(USE_HAL_DRIVER) && defined(HAL_CRYP_MODULE_ENABLED)
+#define AES_BACKEND_HW  1
+#else
+#define AES_BACKEND_HW  0
+#include "aes_soft.h"
+#endif
+
+static uint8_t channel_key[MESH_AES_MAX_KEY_LEN];
+static uint8_t channel_key_len;
 
-#if defined(USE_HAL_DRIVER) && defined(HAL_CRYP_MODULE_ENABLED)
+#if AES_BACKEND_HW
 #include "stm32wlxx_hal_cryp.h"
 #include "stm32wlxx_hal_rcc.h"
 
+#define AES_HW_TIMEOUT_MS  10u   /* per HAL call; a 240-byte payload takes a few µs */
+
 static CRYP_HandleTypeDef hcryp;
-static uint32_t hw_key[4];
+static uint32_t hw_key[8];
 static bool cryp_ready;
 
 void HAL_CRYP_MspInit(CRYP_HandleTypeDef *h) {
@@ -36,7 +53,7 @@ static bool ensure_cryp(void) {
     memset(&hcryp, 0, sizeof(hcryp));
     hcryp.Instance             = AES;
     hcryp.Init.DataType        = CRYP_DATATYPE_32B;
-    hcryp.Init.KeySize         = CRYP_KEYSIZE_128B;
+    hcryp.Init.KeySize         = (channel_key_len == 32) ? CRYP_KEYSIZE_256B : CRYP_KEYSIZE_128B;
     hcryp.Init.pKey            = hw_key;
     hcryp.Init.pInitVect       = NULL;
     hcryp.Init.Algorithm       = CRYP_AES_ECB;
@@ -57,6 +74,78 @@ static void bytes_to_be_words(const uint8_t b[16], uint32_t w[4]) {
                ((uint32_t)b[i*4+2] << 8) | b[i*4+3];
 }
 
+/* The peripheral runs in ECB (the per-block path) or CTR; each path
+ * reprograms it only when the other one ran last. */
+static CRYP_ConfigTypeDef cryp_cfg;
+static uint32_t cryp_algo;
+
+/* Meshtastic nonce as the AES IV register words (big-endian byte order):
+ * packetId LE in bytes 0..3, fromNode LE in bytes 8..11, counter in 12..15. */
+static uint32_t le_to_be32(uint32_t v) {
+    return (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);
+}
+
+/*
+ * Native CTR: key and IV are loaded once per payload (KEYIVCONFIG_ONCE), all
+ * full blocks go through the peripheral in one HAL call, in place, and the
+ * tail (if any) in a second call that continues the hardware counter (the
+ * peripheral increments IV word 3, i.e. nonce bytes 12..15 big-endian, which
+ * matches Meshtastic's CTR counter). DATATYPE_8B makes the peripheral swap
+ * bytes, so payload words are fed as they lie in memory.
+ */
+static uint32_t hw_iv[4];
+
+static bool ctr_configure(uint32_t packet_id, uint32_t from_node) {
+    if (!ensure_cryp()) return false;
+    hw_iv[0] = le_to_be32(packet_id);
+    hw_iv[1] = 0;
+    hw_iv[2] = le_to_be32(from_node);
+    hw_iv[3] = 0;
+    cryp_cfg = hcryp.Init;
+    cryp_cfg.DataType        = CRYP_DATATYPE_8B;
+    cryp_cfg.KeySize         = (channel_key_len == 32) ? CRYP_KEYSIZE_256B : CRYP_KEYSIZE_128B;
+    cryp_cfg.Algorithm       = CRYP_AES_CTR;
+    cryp_cfg.pKey            = hw_key;
+    cryp_cfg.pInitVect       = hw_iv;
+    cryp_cfg.KeyIVConfigSkip = CRYP_KEYIVCONFIG_ONCE;
+    cryp_algo = CRYP_AES_CTR;
+    return HAL_CRYP_SetConfig(&hcryp, &cryp_cfg) == HAL_OK;
+}
+
+static void hw_ctr_crypt(uint8_t *payload, uint16_t len,
+                         uint32_t packet_id, uint32_t from_node)
+{
+    if (!ctr_configure(packet_id, from_node)) return;
+
+    uint16_t full = (uint16_t)(len & ~15u);
+    if (full) {
+        if (((uintptr_t)payload & 3u) == 0) {
+            if (HAL_CRYP_Encrypt(&hcryp, (uint32_t *)payload, full / 4u,
+                                 (uint32_t *)payload, AES_HW_TIMEOUT_MS) != HAL_OK)
+                return;
+        } else {
+            /* Unaligned caller buffer: bounce through an aligned copy */
+            uint32_t tmp[256 / 4];
+            if (full > sizeof(tmp)) return;
+            memcpy(tmp, payload, full);
+            if (HAL_CRYP_Encrypt(&hcryp, tmp, full / 4u, tmp, AES_HW_TIMEOUT_MS) != HAL_OK)
+                return;
+            memcpy(payload, tmp, full);
+        }
+    }
+
+    uint16_t rest = (uint16_t)(len - full);
+    if (rest) {
+        uint32_t blk[4] = { 0, 0, 0, 0 };
+        memcpy(blk, payload + full, rest);
+        if (HAL_CRYP_Encrypt(&hcryp, blk, 4, blk, AES_HW_TIMEOUT_MS) != HAL_OK)
+            return;
+        memcpy(payload + full, blk, rest);
+    }
+}
+
+/* Per-block ECB + software XOR: the path before native CTR */
+
 static void be_words_to_bytes(const uint32_t w[4], uint8_t b[16]) {
     for (int i = 0; i < 4; i++) {
         b[i*4]   = (uint8_t)(w[i] >> 24);
@@ -66,20 +155,35 @@ static void be_words_to_bytes(const uint32_t w[4], uint8_t b[16]) {
     }
 }
 
-static bool aes_ecb_block(const uint8_t in[16], uint8_t out[16]) {
+static bool ecb_configure(void) {
     if (!ensure_cryp()) return false;
+    if (cryp_algo == CRYP_AES_CTR) {
+        cryp_cfg = hcryp.Init;
+        cryp_cfg.DataType        = CRYP_DATATYPE_32B;
+        cryp_cfg.KeySize         = (channel_key_len == 32) ? CRYP_KEYSIZE_256B : CRYP_KEYSIZE_128B;
+        cryp_cfg.Algorithm       = CRYP_AES_ECB;
+        cryp_cfg.pKey            = hw_key;
+        cryp_cfg.pInitVect       = NULL;
+        cryp_cfg.KeyIVConfigSkip = CRYP_KEYIVCONFIG_ALWAYS;
+        if (HAL_CRYP_SetConfig(&hcryp, &cryp_cfg) != HAL_OK) return false;
+    }
+    cryp_algo = CRYP_AES_ECB;
+    return true;
+}
+
+static bool aes_ecb_block(const uint8_t in[16], uint8_t out[16]) {
     uint32_t in_w[4], out_w[4];
     bytes_to_be_words(in, in_w);
-    if (HAL_CRYP_Encrypt(&hcryp, in_w, 4, out_w, 100) != HAL_OK)
+    if (HAL_CRYP_Encrypt(&hcryp, in_w, 4, out_w, AES_HW_TIMEOUT_MS) != HAL_OK)
         return false;
     be_words_to_bytes(out_w, out);
     return true;
 }
 
-void aes_ctr_crypt(uint8_t *payload, uint16_t len,
-                   uint32_t packet_id, uint32_t from_node)
+static void hw_ecb_crypt(uint8_t *payload, uint16_t len,
+                         uint32_t packet_id, uint32_t from_node)
 {
-    if (len == 0) return;
+    if (!ecb_configure()) return;
 
     uint8_t nonce[16];
     memset(nonce, 0, 16);
@@ -96,21 +200,158 @@ void aes_ctr_crypt(uint8_t *payload, uint16_t len,
     }
 }
 
-#else /* no HAL */
+void aes_ctr_crypt(uint8_t *payload, uint16_t len,
+                   uint32_t packet_id, uint32_t from_node)
+{
+    if (len == 0 || channel_key_len == 0) return;
+#if MESH_AES_HW_CTR
+    hw_ctr_crypt(payload, len, packet_id, from_node);
+#else
+    hw_ecb_crypt(payload, len, packet_id, from_node);
+#endif
+}
+
+bool aes_hw_cycles(uint16_t len, uint32_t *ctr_cycles, uint32_t *ecb_cycles) {
+    uint32_t buf[256 / 4];
+    if (len == 0 || len > sizeof(buf) || channel_key_len == 0 ||
+        !ctr_cycles || !ecb_cycles || !(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+        return false;
+    memset(buf, 0xA5, sizeof(buf));
+    /* one untimed pass each, so neither run pays for the first Init */
+    hw_ctr_crypt((uint8_t *)buf, len, 1, 2);
+    hw_ecb_crypt((uint8_t *)buf, len, 1, 2);
+
+    uint32_t t = DWT->CYCCNT;
+    hw_ctr_crypt((uint8_t *)buf, len, 1, 2);
+    *ctr_cycles = DWT->CYCCNT - t;
+    t = DWT->CYCCNT;
+    hw_ecb_crypt((uint8_t *)buf, len, 1, 2);
+    *ecb_cycles = DWT->CYCCNT - t;
+    return true;
+}
+
+#else /* software backend */
+
+static aes_soft_ctx_t soft_ctx;
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
 
 void aes_ctr_crypt(uint8_t *payload, uint16_t len,
                    uint32_t packet_id, uint32_t from_node)
 {
-    (void)payload; (void)len; (void)packet_id; (void)from_node;
+    if (len == 0 || channel_key_len == 0) return;
+    uint8_t nonce[16] = { 0 };
+    put_le32(nonce, packet_id);
+    put_le32(nonce + 8, from_node);
+    aes_soft_ctr(&soft_ctx, nonce, payload, len);
+}
+
+bool aes_hw_cycles(uint16_t len, uint32_t *ctr_cycles, uint32_t *ecb_cycles) {
+    (void)len; (void)ctr_cycles; (void)ecb_cycles;
+    return false;
 }
 
 #endif
 
-void aes_set_channel_key(const uint8_t *key) {
-    if (!key) return;
-    memcpy(channel_key, key, MESH_AES_KEY_LEN);
-#if defined(USE_HAL_DRIVER) && defined(HAL_CRYP_MODULE_ENABLED)
+bool aes_set_channel_key(const uint8_t *key, uint8_t key_len) {
+    if (!key || (key_len != 16 && key_len != 32)) return false;
+    memcpy(channel_key, key, key_len);
+    channel_key_len = key_len;
+#if AES_BACKEND_HW
     bytes_to_be_words(channel_key, hw_key);
-    cryp_ready = false;
+    if (key_len == 32) bytes_to_be_words(channel_key + 16, hw_key + 4);
+    cryp_ready = false;   /* key size may have changed: re-Init on next use */
+    cryp_algo = CRYP_AES_ECB;
+#else
+    aes_soft_set_key(&soft_ctx, key, key_len);   /* schedule precomputed once per key */
+#endif
+    return true;
+}
+
+const char *aes_backend_name(void) {
+#if AES_BACKEND_HW
+    return MESH_AES_HW_CTR ? "hw-ctr" : "hw-ecb";
+#else
+    return aes_soft_accelerated() ? "soft+aesni" : "soft";
 #endif
 }
+
+/* ---- Known answers with the Meshtastic nonce (packetId 0x12345678, from
+ * 0xA1B2C3D4), cross-checked with OpenSSL aes-{128,256}-ctr ---- */
+
+static const uint8_t kat_psk128[16] = {     /* Meshtastic default channel key */
+    0xd4, 0xf1, 0xbb, 0x3a, 0x20, 0x29, 0x07, 0x59, 0xf0, 0xbc, 0xff, 0xab, 0xcf, 0x4e, 0x69, 0x01,
+};
+static const uint8_t kat_data_pt[9] = { 0x08, 0x01, 0x12, 0x05, 'h', 'e', 'l', 'l', 'o' };
+static const uint8_t kat_data_ct[9] = { 0xff, 0xf0, 0x53, 0x99, 0x88, 0x2a, 0xaa, 0xf0, 0x41 };
+/* plaintext 00 01 .. 27 (40 bytes: two full blocks + tail) */
+static const uint8_t kat_seq_ct128[40] = {
+    0xf7, 0xf0, 0x43, 0x9f, 0xe4, 0x4a, 0xc0, 0x9b, 0x26, 0x19, 0xf9, 0x7e, 0xd6, 0x1a, 0x46, 0x55,
+    0x63, 0xa3, 0x2d, 0x35, 0xd7, 0x7e, 0x83, 0x1b, 0xc9, 0x24, 0x17, 0xe9, 0x96, 0x69, 0x7d, 0x8c,
+    0x23, 0xae, 0x05, 0xa3, 0xd7, 0xdf, 0x4c, 0xb6,
+};
+/* key 00 01 .. 1f */
+static const uint8_t kat_seq_ct256[40] = {
+    0x54, 0x43, 0x88, 0xd8, 0x9a, 0xfd, 0x06, 0x6c, 0x5b, 0x55, 0x68, 0x43, 0x92, 0x41, 0xd9, 0x26,
+    0x1e, 0x18, 0x87, 0xe1, 0x8c, 0xe4, 0xbc, 0x8f, 0x0d, 0x39, 0xf3, 0xde, 0x19, 0x3c, 0x69, 0x90,
+    0x41, 0xa5, 0xc2, 0x33, 0x8e, 0x30, 0xdf, 0x33,
+};
+
+#define KAT_PACKET_ID  0x12345678u
+#define KAT_FROM_NODE  0xA1B2C3D4u
+
+static bool kat_ctr(const uint8_t *key, uint8_t key_len, const uint8_t *pt,
+                    const uint8_t *ct, uint16_t len)
+{
+    uint32_t buf[40 / 4];              /* word-aligned like the radio buffers */
+    uint8_t *b = (uint8_t *)buf;
+    if (len > sizeof(buf) || !aes_set_channel_key(key, key_len)) return false;
+    memcpy(b, pt, len);
+    aes_ctr_crypt(b, len, KAT_PACKET_ID, KAT_FROM_NODE);
+    if (memcmp(b, ct, len) != 0) return false;
+    aes_ctr_crypt(b, len, KAT_PACKET_ID, KAT_FROM_NODE);   /* CTR is its own inverse */
+    return memcmp(b, pt, len) == 0;
+}
+
+bool aes_self_test(void) {
+    uint8_t saved[MESH_AES_MAX_KEY_LEN];
+    uint8_t saved_len = channel_key_len;
+    memcpy(saved, channel_key, sizeof(saved));
+
+    uint8_t seq[40], key256[32];
+    for (uint8_t i = 0; i < 40; i++) seq[i] = i;
+    for (uint8_t i = 0; i < 32; i++) key256[i] = i;
+
+    bool ok = true;
+#if !AES_BACKEND_HW
+    ok = aes_soft_self_test();
+#endif
+    ok = ok && kat_ctr(kat_psk128, 16, kat_data_pt, kat_data_ct, sizeof(kat_data_pt));
+    ok = ok && kat_ctr(kat_psk128, 16, seq, kat_seq_ct128, sizeof(seq));
+    ok = ok && kat_ctr(key256, 32, seq, kat_seq_ct256, sizeof(seq));
+
+    if (saved_len) aes_set_channel_key(saved, saved_len);
+    else channel_key_len = 0;
+    return ok;
+}
+
+uint32_t aes_benchmark(uint16_t len, uint32_t duration_ms, uint32_t (*now_ms)(void)) {
+    uint32_t buf[256 / 4];
+    if (!now_ms || len == 0 || len > sizeof(buf) || channel_key_len == 0) return 0;
+    memset(buf, 0xA5, sizeof(buf));
+    uint32_t start = now_ms(), elapsed = 0;
+    uint32_t iters = 0;
+    /* Iteration cap: a clock that never advances must not hang the caller */
+    while (elapsed < duration_ms && iters < 1000000u) {
+        aes_ctr_crypt((uint8_t *)buf, len, iters, 0x01020304u);
+        iters++;
+        elapsed = now_ms() - start;
+    }
+    if (elapsed == 0) return 0;
+    return (uint32_t)((uint64_t)iters * len * 1000u / elapsed);
+}
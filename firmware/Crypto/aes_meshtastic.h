@@ -1,5 +1,6 @@
 /**
- * AES-128-CTR for Meshtastic channel payload (STM32WLE5 hardware AES).
+ * AES-128/256-CTR for Meshtastic channel payload (STM32WLE5 hardware AES, or
+ * the software backend in aes_soft.c).
  * Nonce = packetId(8 LE) + fromNode(4 LE) + blockCounter(4).
  * Header is NOT encrypted; only payload after 16-byte header.
  */
@@ -14,17 +15,50 @@
 extern "C" {
 #endif
 
-#define MESH_AES_KEY_LEN 16
+#define MESH_AES_KEY_LEN     16
+#define MESH_AES_MAX_KEY_LEN 32
 
-void aes_set_channel_key(const uint8_t *key);
+/* 1 = software AES even when the HAL AES peripheral is available
+ * (CMake -DMESH_AES_SOFT=ON). Without the HAL the software backend is always used. */
+#ifndef MESH_AES_SOFT
+#define MESH_AES_SOFT  0
+#endif
+
+/* 1 = hardware AES-CTR over the whole payload; 0 = per-block ECB + software XOR */
+#ifndef MESH_AES_HW_CTR
+#define MESH_AES_HW_CTR  1
+#endif
+
+/* 16-byte PSK = AES-128, 32-byte = AES-256; other lengths are rejected.
+ * Key schedule / peripheral key words are prepared here, not per packet. */
+bool aes_set_channel_key(const uint8_t *key, uint8_t key_len);
 
 /**
- * AES-128-CTR encrypt/decrypt in place (same operation for CTR mode).
+ * AES-CTR encrypt/decrypt in place (same operation for CTR mode). No-op until a key is set.
  * Meshtastic nonce: packetId(8 LE) + fromNode(4 LE) + counter(4).
  */
 void aes_ctr_crypt(uint8_t *payload, uint16_t len,
                    uint32_t packet_id, uint32_t from_node);
 
+/* "hw-ctr", "hw-ecb", "soft" or "soft+aesni" */
+const char *aes_backend_name(void);
+
+/* Known-answer test of the active backend: Meshtastic-nonce CTR vectors for
+ * AES-128 and AES-256 (plus FIPS-197 block vectors for the software AES).
+ * The channel key is restored afterwards. */
+bool aes_self_test(void);
+
+/* DWT cycles for one len-byte payload through the hardware native-CTR path
+ * and through per-block ECB + software XOR (MESH_AES_HW_CTR=1 / 0), with the
+ * current key. False without the AES peripheral, a key or CYCCNT running. */
+bool aes_hw_cycles(uint16_t len, uint32_t *ctr_cycles, uint32_t *ecb_cycles);
+
+/* Throughput of aes_ctr_crypt on len-byte payloads with the current key, in
+ * bytes/s, measured for duration_ms with the given clock. 0 if no key or the
+ * clock does not advance. Busy for the whole duration: for benchmarks
+ * (tests/bench_aes.c), not the main loop. */
+uint32_t aes_benchmark(uint16_t len, uint32_t duration_ms, uint32_t (*now_ms)(void));
+
 #ifdef __cplusplus
 }
 #endif
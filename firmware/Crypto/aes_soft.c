@@ -0,0 +1,188 @@
+/**
+ * Software AES: S-box table, MixColumns by shift/xor with a branch-free xtime.
+ * On Cortex-M4 (no data cache) the 256-byte S-box lookups have constant
+ * timing; on cached hosts the AES-NI path is used when the CPU has it.
+ */
+
+#include "aes_soft.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(AES_SOFT_NO_AESNI)
+#define AES_SOFT_HAVE_AESNI 1
+#include <wmmintrin.h>
+#endif
+
+static const uint8_t sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static uint8_t xtime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ (0x1B & (uint8_t)-(x >> 7)));
+}
+
+bool aes_soft_set_key(aes_soft_ctx_t *ctx, const uint8_t *key, uint8_t key_len) {
+    if (!ctx) return false;
+    memset(ctx, 0, sizeof(*ctx));
+    if (!key || (key_len != 16 && key_len != 32)) return false;
+
+    uint8_t nk = key_len / 4u;
+    ctx->rounds = (uint8_t)(nk + 6u);
+    uint8_t total = (uint8_t)(4u * (ctx->rounds + 1u));   /* words */
+    uint8_t *w = ctx->rk;
+    memcpy(w, key, key_len);
+
+    uint8_t rcon = 0x01;
+    for (uint8_t i = nk; i < total; i++) {
+        uint8_t t[4];
+        memcpy(t, w + 4u * (i - 1u), 4);
+        if (i % nk == 0) {
+            uint8_t t0 = t[0];
+            t[0] = (uint8_t)(sbox[t[1]] ^ rcon);
+            t[1] = sbox[t[2]];
+            t[2] = sbox[t[3]];
+            t[3] = sbox[t0];
+            rcon = xtime(rcon);
+        } else if (nk > 6 && i % nk == 4) {
+            for (int j = 0; j < 4; j++) t[j] = sbox[t[j]];
+        }
+        for (int j = 0; j < 4; j++)
+            w[4u * i + j] = (uint8_t)(w[4u * (i - nk) + j] ^ t[j]);
+    }
+    return true;
+}
+
+static void add_round_key(uint8_t s[16], const uint8_t *rk) {
+    for (int i = 0; i < 16; i++) s[i] ^= rk[i];
+}
+
+/* SubBytes + ShiftRows (state is column-major: s[4*col + row]) */
+static void sub_shift(uint8_t s[16]) {
+    uint8_t t[16];
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            t[4 * c + r] = sbox[s[4 * ((c + r) & 3) + r]];
+    memcpy(s, t, 16);
+}
+
+static void mix_columns(uint8_t s[16]) {
+    for (int c = 0; c < 4; c++) {
+        uint8_t *col = s + 4 * c;
+        uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+        uint8_t all = (uint8_t)(a0 ^ a1 ^ a2 ^ a3);
+        col[0] = (uint8_t)(a0 ^ all ^ xtime((uint8_t)(a0 ^ a1)));
+        col[1] = (uint8_t)(a1 ^ all ^ xtime((uint8_t)(a1 ^ a2)));
+        col[2] = (uint8_t)(a2 ^ all ^ xtime((uint8_t)(a2 ^ a3)));
+        col[3] = (uint8_t)(a3 ^ all ^ xtime((uint8_t)(a3 ^ a0)));
+    }
+}
+
+static void portable_encrypt_block(const aes_soft_ctx_t *ctx, const uint8_t in[16], uint8_t out[16]) {
+    uint8_t s[16];
+    memcpy(s, in, 16);
+    add_round_key(s, ctx->rk);
+    for (uint8_t r = 1; r < ctx->rounds; r++) {
+        sub_shift(s);
+        mix_columns(s);
+        add_round_key(s, ctx->rk + 16u * r);
+    }
+    sub_shift(s);
+    add_round_key(s, ctx->rk + 16u * ctx->rounds);
+    memcpy(out, s, 16);
+}
+
+#if AES_SOFT_HAVE_AESNI
+__attribute__((target("aes,sse2")))
+static void aesni_encrypt_block(const aes_soft_ctx_t *ctx, const uint8_t in[16], uint8_t out[16]) {
+    const __m128i *rk = (const __m128i *)(const void *)ctx->rk;
+    __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(const void *)in), _mm_loadu_si128(rk));
+    for (uint8_t r = 1; r < ctx->rounds; r++)
+        s = _mm_aesenc_si128(s, _mm_loadu_si128(rk + r));
+    s = _mm_aesenclast_si128(s, _mm_loadu_si128(rk + ctx->rounds));
+    _mm_storeu_si128((__m128i *)(void *)out, s);
+}
+
+static int aesni_state = -1;   /* -1 unknown, 0 no, 1 yes */
+#endif
+
+bool aes_soft_accelerated(void) {
+#if AES_SOFT_HAVE_AESNI
+    if (aesni_state < 0) {
+        __builtin_cpu_init();
+        aesni_state = __builtin_cpu_supports("aes") ? 1 : 0;
+    }
+    return aesni_state == 1;
+#else
+    return false;
+#endif
+}
+
+void aes_soft_encrypt_block(const aes_soft_ctx_t *ctx, const uint8_t in[16], uint8_t out[16]) {
+    if (!ctx || ctx->rounds == 0) return;
+#if AES_SOFT_HAVE_AESNI
+    if (aes_soft_accelerated()) {
+        aesni_encrypt_block(ctx, in, out);
+        return;
+    }
+#endif
+    portable_encrypt_block(ctx, in, out);
+}
+
+void aes_soft_ctr(const aes_soft_ctx_t *ctx, const uint8_t iv[16], uint8_t *data, uint16_t len) {
+    if (!ctx || ctx->rounds == 0 || !data) return;
+    uint8_t ctr[16], ks[16];
+    memcpy(ctr, iv, 16);
+    for (uint16_t off = 0; off < len; off += 16) {
+        aes_soft_encrypt_block(ctx, ctr, ks);
+        uint16_t n = (len - off > 16) ? 16 : (uint16_t)(len - off);
+        for (uint16_t j = 0; j < n; j++)
+            data[off + j] ^= ks[j];
+        for (int j = 15; j >= 12; j--)      /* 32-bit big-endian increment */
+            if (++ctr[j] != 0) break;
+    }
+}
+
+/* FIPS-197 Appendix C.1 / C.3 */
+static const uint8_t kat_pt[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+static const uint8_t kat_ct128[16] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+};
+static const uint8_t kat_ct256[16] = {
+    0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89,
+};
+
+static bool kat_one(uint8_t key_len, const uint8_t expect[16]) {
+    uint8_t key[32], out[16];
+    for (uint8_t i = 0; i < key_len; i++) key[i] = i;
+    aes_soft_ctx_t ctx;
+    if (!aes_soft_set_key(&ctx, key, key_len)) return false;
+    portable_encrypt_block(&ctx, kat_pt, out);
+    if (memcmp(out, expect, 16) != 0) return false;
+#if AES_SOFT_HAVE_AESNI
+    if (aes_soft_accelerated()) {
+        aesni_encrypt_block(&ctx, kat_pt, out);
+        if (memcmp(out, expect, 16) != 0) return false;
+    }
+#endif
+    return true;
+}
+
+bool aes_soft_self_test(void) {
+    return kat_one(16, kat_ct128) && kat_one(32, kat_ct256);
+}
@@ -0,0 +1,45 @@
+/**
+ * Portable software AES-128/256 (encrypt direction only, enough for CTR).
+ * Byte-oriented S-box implementation without data-dependent branches; on
+ * x86 hosts with AES-NI the block function is switched at runtime to the
+ * hardware instructions. Used by aes_meshtastic when built with
+ * MESH_AES_SOFT=1 or without the STM32 HAL.
+ */
+
+#ifndef AES_SOFT_H
+#define AES_SOFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AES_SOFT_MAX_ROUNDS  14
+
+typedef struct {
+    uint8_t rk[16 * (AES_SOFT_MAX_ROUNDS + 1)];   /* expanded key, FIPS-197 byte order */
+    uint8_t rounds;                                /* 10 (AES-128) or 14 (AES-256); 0 = no key */
+} aes_soft_ctx_t;
+
+/* Expand a 16- or 32-byte key. Returns false for other lengths (ctx cleared). */
+bool aes_soft_set_key(aes_soft_ctx_t *ctx, const uint8_t *key, uint8_t key_len);
+
+void aes_soft_encrypt_block(const aes_soft_ctx_t *ctx, const uint8_t in[16], uint8_t out[16]);
+
+/* CTR in place. The counter is the big-endian 32-bit word in iv[12..15]. */
+void aes_soft_ctr(const aes_soft_ctx_t *ctx, const uint8_t iv[16], uint8_t *data, uint16_t len);
+
+/* true when blocks run on AES-NI */
+bool aes_soft_accelerated(void);
+
+/* FIPS-197 Appendix C known answers (AES-128 and AES-256), portable path and,
+ * when present, AES-NI. */
+bool aes_soft_self_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_SOFT_H */
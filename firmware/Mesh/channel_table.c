@@ -0,0 +1,66 @@
+/**
+ * Channel table with hash-indexed candidate lookup.
+ */
+
+#include "channel_table.h"
+#include <string.h>
+
+static config_channel_t table[CONFIG_MAX_CHANNELS];
+static uint8_t hashes[CONFIG_MAX_CHANNELS];
+static uint8_t count;
+static uint8_t by_hash[256];      /* bit i set = channel i has this hash */
+static channel_stats_t stats;
+
+uint8_t channel_hash(const char *name, const uint8_t *psk, uint8_t psk_len) {
+    uint8_t h = 0;
+    if (name) {
+        for (size_t i = 0; i < CONFIG_CHANNEL_NAME_LEN && name[i]; i++)
+            h ^= (uint8_t)name[i];
+    }
+    for (uint8_t i = 0; psk && i < psk_len; i++)
+        h ^= psk[i];
+    return h;
+}
+
+void channel_table_build(const config_channel_t *channels, uint8_t n) {
+    memset(by_hash, 0, sizeof(by_hash));
+    count = 0;
+    if (!channels) return;
+    if (n > CONFIG_MAX_CHANNELS) n = CONFIG_MAX_CHANNELS;
+    for (uint8_t i = 0; i < n; i++) {
+        table[i] = channels[i];
+        table[i].name[CONFIG_CHANNEL_NAME_LEN - 1] = '\0';
+        if (table[i].psk_len > CONFIG_PSK_MAX_LEN) table[i].psk_len = CONFIG_PSK_MAX_LEN;
+        hashes[i] = channel_hash(table[i].name, table[i].psk, table[i].psk_len);
+        by_hash[hashes[i]] |= (uint8_t)(1u << i);
+    }
+    count = n;
+}
+
+uint8_t channel_table_count(void) {
+    return count;
+}
+
+const config_channel_t *channel_table_get(uint8_t idx) {
+    return idx < count ? &table[idx] : NULL;
+}
+
+uint8_t channel_table_hash(uint8_t idx) {
+    return idx < count ? hashes[idx] : 0;
+}
+
+uint8_t channel_table_candidates(uint8_t hash) {
+    uint8_t mask = by_hash[hash];
+    stats.lookups++;
+    if (mask == 0) stats.skipped++;
+    else if (mask & (mask - 1u)) stats.collisions++;
+    return mask;
+}
+
+void channel_table_note_undecodable(void) {
+    stats.undecodable++;
+}
+
+void channel_table_get_stats(channel_stats_t *out) {
+    if (out) *out = stats;
+}
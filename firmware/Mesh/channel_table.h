@@ -0,0 +1,50 @@
+/**
+ * Channel table: up to CONFIG_MAX_CHANNELS (name, PSK) pairs with their
+ * Meshtastic channel hash precomputed. A 256-entry hash -> channel bitmask
+ * index answers "which keys could decrypt this frame" from the header's
+ * channel byte in one load, so frames for channels we do not have are
+ * dropped before any AES work.
+ */
+
+#ifndef CHANNEL_TABLE_H
+#define CHANNEL_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../Config/config_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t skipped;        /* no channel with that hash: not decrypted */
+    uint32_t collisions;     /* more than one candidate key for a hash */
+    uint32_t undecodable;    /* matched by hash but no candidate key decoded it */
+} channel_stats_t;
+
+/* Meshtastic channel hash: xor of name bytes ^ xor of PSK bytes. */
+uint8_t channel_hash(const char *name, const uint8_t *psk, uint8_t psk_len);
+
+/* (Re)build the index from the config channel list. */
+void channel_table_build(const config_channel_t *channels, uint8_t count);
+
+uint8_t channel_table_count(void);
+const config_channel_t *channel_table_get(uint8_t idx);
+uint8_t channel_table_hash(uint8_t idx);
+
+/* Bitmask of channel indices whose hash equals the header byte (0 = skip).
+ * Counts a lookup, and a skip when the mask is empty. */
+uint8_t channel_table_candidates(uint8_t hash);
+
+/* Called when none of the candidates produced a valid payload. */
+void channel_table_note_undecodable(void);
+
+void channel_table_get_stats(channel_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHANNEL_TABLE_H */
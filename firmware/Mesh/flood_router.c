@@ -1,41 +1,163 @@
 /**
- * Simple deduplication: ring buffer of recent (from_id, packet_id).
- * In practice better to limit by time or count.
+ * Deduplication: open-addressed hash table of recent (from_id, packet_id)
+ * with linear probing. Expired entries count as free. A key goes into the
+ * first free or expired slot from its home slot, however far that is, so a
+ * live entry is only overwritten when every slot holds one. probe_len
+ * bounds how far past its home slot any live key sits: lookups scan that
+ * many slots (or stop at a never-used one). It is recomputed from the live
+ * entries every FLOOD_DEDUP_CAPACITY inserts, so it shrinks again once the
+ * keys that were pushed far expire.
  */
 
 #include "flood_router.h"
 #include <string.h>
 
-#define SEEN_SIZE 32
+#if (FLOOD_DEDUP_CAPACITY & (FLOOD_DEDUP_CAPACITY - 1)) != 0
+#error "FLOOD_DEDUP_CAPACITY must be a power of two"
+#endif
 
-typedef struct { uint32_t from; uint32_t id; } seen_t;
-static seen_t seen_buf[SEEN_SIZE];
-static uint8_t seen_head;
+#define DEDUP_MASK  (FLOOD_DEDUP_CAPACITY - 1u)
 
-void flood_seen(uint32_t from_id, uint32_t packet_id) {
-    seen_buf[seen_head].from = from_id;
-    seen_buf[seen_head].id   = packet_id;
-    seen_head = (seen_head + 1) % SEEN_SIZE;
+/* Slot time for LongFast (SF11 / 250 kHz) until flood_set_modem is called */
+#define DEFAULT_SLOT_MS  77u
+
+typedef struct { uint32_t from; uint32_t id; uint32_t t_ms; } seen_t;
+static seen_t seen_tab[FLOOD_DEDUP_CAPACITY];
+static uint32_t seen_used[(FLOOD_DEDUP_CAPACITY + 31) / 32];   /* slot ever occupied bitmap */
+static uint32_t probe_len;          /* live keys sit < probe_len slots past home */
+static uint32_t inserts_since_scan;
+static flood_dedup_stats_t stats;
+
+static flood_relay_t relays[FLOOD_RELAY_SLOTS];
+static flood_relay_stats_t relay_stats;
+static uint32_t slot_ms = DEFAULT_SLOT_MS;
+
+static inline bool slot_used(uint32_t i) { return (seen_used[i >> 5] >> (i & 31)) & 1u; }
+static inline void slot_mark(uint32_t i) { seen_used[i >> 5] |= 1u << (i & 31); }
+
+static inline bool slot_expired(uint32_t i, uint32_t now_ms) {
+    return (uint32_t)(now_ms - seen_tab[i].t_ms) >= FLOOD_DEDUP_MAX_AGE_MS;
+}
+
+static inline uint32_t key_hash(uint32_t from_id, uint32_t packet_id) {
+    uint32_t h = from_id * 0x9E3779B1u ^ packet_id;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+}
+
+/* Scan the key's chain. Returns the index of a live match, or -1. With
+ * slot != NULL, also finds where the key should go: the first free or
+ * expired slot (*dist from home), else (table full) the oldest entry within
+ * probe_len, with *slot_live set. */
+static int32_t dedup_probe(uint32_t from_id, uint32_t packet_id, uint32_t now_ms,
+                           uint32_t *slot, uint32_t *dist, bool *slot_live)
+{
+    uint32_t base = key_hash(from_id, packet_id);
+    int32_t free_idx = -1;
+    uint32_t free_dist = 0;
+    uint32_t oldest = base & DEDUP_MASK;
+    uint32_t oldest_age = 0;
+
+    for (uint32_t k = 0; k < FLOOD_DEDUP_CAPACITY; k++) {
+        if (k >= probe_len && (free_idx >= 0 || !slot))
+            break;
+        uint32_t i = (base + k) & DEDUP_MASK;
+        if (!slot_used(i)) {
+            /* never occupied: no key was ever pushed past it */
+            if (free_idx < 0) {
+                free_idx = (int32_t)i;
+                free_dist = k;
+            }
+            break;
+        }
+        if (slot_expired(i, now_ms)) {
+            if (free_idx < 0) {
+                free_idx = (int32_t)i;
+                free_dist = k;
+            }
+            continue;
+        }
+        if (seen_tab[i].from == from_id && seen_tab[i].id == packet_id)
+            return (int32_t)i;
+        uint32_t age = now_ms - seen_tab[i].t_ms;
+        if (k < probe_len && age >= oldest_age) {
+            oldest_age = age;
+            oldest = i;
+        }
+    }
+    if (!slot) return -1;
+    if (free_idx >= 0) {
+        *slot = (uint32_t)free_idx;
+        *dist = free_dist;
+        *slot_live = false;
+    } else {
+        *slot = oldest;
+        *dist = 0;
+        *slot_live = true;
+    }
+    return -1;
+}
+
+/* Live entries now; probe_len from their distances to home */
+static uint16_t dedup_rescan(uint32_t now_ms) {
+    uint16_t live = 0;
+    uint32_t len = 0;
+    for (uint32_t i = 0; i < FLOOD_DEDUP_CAPACITY; i++) {
+        if (!slot_used(i) || slot_expired(i, now_ms)) continue;
+        live++;
+        uint32_t d = (i - key_hash(seen_tab[i].from, seen_tab[i].id)) & DEDUP_MASK;
+        if (d + 1u > len) len = d + 1u;
+    }
+    probe_len = len;
+    inserts_since_scan = 0;
+    return live;
 }
 
-bool flood_was_seen(uint32_t from_id, uint32_t packet_id) {
-    for (int i = 0; i < SEEN_SIZE; i++) {
-        if (seen_buf[i].from == from_id && seen_buf[i].id == packet_id)
-            return true;
+bool flood_check_and_insert(uint32_t from_id, uint32_t packet_id, uint32_t now_ms) {
+    uint32_t slot, dist;
+    bool live;
+    stats.lookups++;
+    if (dedup_probe(from_id, packet_id, now_ms, &slot, &dist, &live) >= 0) {
+        stats.hits++;
+        return true;
     }
+    if (live)
+        stats.evictions++;
+    else if (slot_used(slot))
+        stats.expired++;
+    seen_tab[slot].from = from_id;
+    seen_tab[slot].id   = packet_id;
+    seen_tab[slot].t_ms = now_ms;
+    slot_mark(slot);
+    if (dist + 1u > probe_len) probe_len = dist + 1u;
+    stats.inserts++;
+    if (++inserts_since_scan >= FLOOD_DEDUP_CAPACITY)
+        (void)dedup_rescan(now_ms);
     return false;
 }
 
-bool flood_should_forward(const uint8_t *lora_packet, uint16_t len) {
-    if (!lora_packet || len < MESH_HEADER_SIZE) return false;
-    mesh_lora_header_t h;
-    mesh_header_from_buf(&h, lora_packet);
-    if (flood_was_seen(h.from_id, h.packet_id)) return false;
-    uint8_t hop = mesh_hop_limit(h.flags);
-    if (hop == 0) return false;
+void flood_seen(uint32_t from_id, uint32_t packet_id, uint32_t now_ms) {
+    (void)flood_check_and_insert(from_id, packet_id, now_ms);
+}
+
+bool flood_was_seen(uint32_t from_id, uint32_t packet_id, uint32_t now_ms) {
+    stats.lookups++;
+    if (dedup_probe(from_id, packet_id, now_ms, NULL, NULL, NULL) < 0) return false;
+    stats.hits++;
     return true;
 }
 
+void flood_get_stats(flood_dedup_stats_t *out, uint32_t now_ms) {
+    if (!out) return;
+    uint16_t live = dedup_rescan(now_ms);
+    memcpy(out, &stats, sizeof(*out));
+    out->occupancy = live;
+    out->capacity = FLOOD_DEDUP_CAPACITY;
+    out->probe_len = (uint16_t)probe_len;
+}
+
 void flood_prepare_forward(uint8_t *lora_packet, uint16_t len, uint8_t my_node_id) {
     if (!lora_packet || len < MESH_HEADER_SIZE) return;
     mesh_lora_header_t h;
@@ -46,3 +168,97 @@ void flood_prepare_forward(uint8_t *lora_packet, uint16_t len, uint8_t my_node_i
     h.relay = my_node_id; /* or next_hop depending on semantics */
     mesh_header_to_buf(&h, lora_packet);
 }
+
+/* --- Managed flooding: SNR-weighted contention delay --- */
+
+void flood_set_modem(uint8_t sf, uint32_t bw_hz) {
+    if (bw_hz == 0 || sf > 12) return;
+    /* Meshtastic slotTimeMsec = 8.5 * 2^SF / BW_kHz + 0.2 + 0.4 + 7 */
+    slot_ms = (uint32_t)(((uint64_t)8500u << sf) / bw_hz) + 8u;
+}
+
+/* SNR_MIN..SNR_MAX maps linearly onto CW_MIN..CW_MAX (clamped). */
+static uint8_t snr_to_cw(int8_t snr) {
+    int32_t s = snr;
+    if (s < FLOOD_SNR_MIN) s = FLOOD_SNR_MIN;
+    if (s > FLOOD_SNR_MAX) s = FLOOD_SNR_MAX;
+    int32_t cw = FLOOD_CW_MIN + ((s - FLOOD_SNR_MIN) * (FLOOD_CW_MAX - FLOOD_CW_MIN) +
+                                 (FLOOD_SNR_MAX - FLOOD_SNR_MIN) / 2) /
+                                (FLOOD_SNR_MAX - FLOOD_SNR_MIN);
+    return (uint8_t)cw;
+}
+
+uint32_t flood_relay_delay_ms(int8_t snr, uint32_t rnd) {
+    uint8_t cw = snr_to_cw(snr);
+    /* random slot in [0, 2^cw) */
+    return (rnd & ((1u << cw) - 1u)) * slot_ms;
+}
+
+bool flood_schedule_relay(const uint8_t *lora_packet, uint16_t len, int8_t snr,
+                          uint8_t my_node_id, uint32_t rnd, uint32_t now_ms)
+{
+    if (!lora_packet || len < MESH_HEADER_SIZE || len > FLOOD_FRAME_MAX) return false;
+    flood_relay_t *r = NULL;
+    for (uint32_t i = 0; i < FLOOD_RELAY_SLOTS; i++) {
+        if (!relays[i].active) { r = &relays[i]; break; }
+    }
+    if (!r) {
+        relay_stats.dropped++;
+        return false;
+    }
+    mesh_lora_header_t h;
+    mesh_header_from_buf(&h, lora_packet);
+    memcpy(r->frame, lora_packet, len);
+    flood_prepare_forward(r->frame, len, my_node_id);
+    r->from_id   = h.from_id;
+    r->packet_id = h.packet_id;
+    r->len       = len;
+    r->due_ms    = now_ms + flood_relay_delay_ms(snr, rnd);
+    r->active    = true;
+    relay_stats.scheduled++;
+    return true;
+}
+
+void flood_on_duplicate(uint32_t from_id, uint32_t packet_id) {
+    for (uint32_t i = 0; i < FLOOD_RELAY_SLOTS; i++) {
+        flood_relay_t *r = &relays[i];
+        if (r->active && r->from_id == from_id && r->packet_id == packet_id) {
+            r->active = false;
+            relay_stats.suppressed++;
+        }
+    }
+}
+
+flood_relay_t *flood_due_relay(uint32_t now_ms) {
+    flood_relay_t *best = NULL;
+    for (uint32_t i = 0; i < FLOOD_RELAY_SLOTS; i++) {
+        flood_relay_t *r = &relays[i];
+        if (!r->active || (int32_t)(now_ms - r->due_ms) < 0) continue;
+        if (!best || (int32_t)(r->due_ms - best->due_ms) < 0) best = r;
+    }
+    return best;
+}
+
+bool flood_next_relay_ms(uint32_t now_ms, uint32_t *in_ms) {
+    bool any = false;
+    for (uint32_t i = 0; i < FLOOD_RELAY_SLOTS; i++) {
+        const flood_relay_t *r = &relays[i];
+        if (!r->active) continue;
+        int32_t left = (int32_t)(r->due_ms - now_ms);
+        uint32_t ms = left > 0 ? (uint32_t)left : 0;
+        if (!any || ms < *in_ms) *in_ms = ms;
+        any = true;
+    }
+    return any;
+}
+
+void flood_relay_done(flood_relay_t *r, bool queued) {
+    if (!r || !r->active) return;
+    r->active = false;
+    if (queued) relay_stats.sent++;
+    else relay_stats.dropped++;
+}
+
+void flood_get_relay_stats(flood_relay_stats_t *out) {
+    if (out) memcpy(out, &relay_stats, sizeof(*out));
+}
@@ -1,5 +1,12 @@
 /**
  * Flood routing: relay by hop_limit and deduplication by (from_id, packet_id).
+ * Dedup is an open-addressed hash table with a bounded probe window and
+ * age-based expiry, so old packets drop out by time rather than by wrap-around.
+ *
+ * Managed flooding (as Meshtastic): a relay is not sent immediately but held
+ * for a random delay whose contention window grows with the received SNR, so
+ * far-away nodes (low SNR) relay first. Hearing the same packet relayed by
+ * someone else before our slot cancels our pending relay.
  */
 
 #ifndef FLOOD_ROUTER_H
@@ -13,22 +20,96 @@
 extern "C" {
 #endif
 
-/* Call on raw LoRa packet receive (header + payload).
- * - If packet already seen — returns false (do not relay).
- * - If hop_limit == 0 — returns false.
- * - Otherwise registers packet, decrements hop_limit and returns true (may relay).
- */
-bool flood_should_forward(const uint8_t *lora_packet, uint16_t len);
+/* Dedup table slots (power of two, 12 bytes each). Live entries are only
+ * evicted when all slots are live; keep the packets heard per
+ * FLOOD_DEDUP_MAX_AGE_MS under ~3/4 of it so lookups stay short. */
+#ifndef FLOOD_DEDUP_CAPACITY
+#define FLOOD_DEDUP_CAPACITY    128
+#endif
+/* Entries older than this are treated as unseen and may be reused */
+#ifndef FLOOD_DEDUP_MAX_AGE_MS
+#define FLOOD_DEDUP_MAX_AGE_MS  (5u * 60u * 1000u)
+#endif
+
+/* Pending relays held until their slot (each holds a full frame copy) */
+#ifndef FLOOD_RELAY_SLOTS
+#define FLOOD_RELAY_SLOTS       4
+#endif
+/* Contention window exponent range and the SNR span mapped onto it */
+#define FLOOD_CW_MIN            3
+#define FLOOD_CW_MAX            8
+#define FLOOD_SNR_MIN           (-20)
+#define FLOOD_SNR_MAX           10
+#define FLOOD_FRAME_MAX         256
+
+typedef struct {
+    uint32_t lookups;       /* flood_check_and_insert / flood_was_seen calls */
+    uint32_t hits;          /* duplicates found */
+    uint32_t inserts;       /* new keys recorded */
+    uint32_t expired;       /* inserts that reused an expired slot */
+    uint32_t evictions;     /* inserts that overwrote a live entry (table full) */
+    uint16_t occupancy;     /* live (non-expired) entries */
+    uint16_t capacity;
+    uint16_t probe_len;     /* slots a lookup scans at most */
+} flood_dedup_stats_t;
+
+typedef struct {
+    uint32_t scheduled;     /* relays queued with a contention delay */
+    uint32_t sent;          /* relays moved into the TX queue */
+    uint32_t suppressed;    /* cancelled: heard relayed by another node first */
+    uint32_t dropped;       /* no free relay slot, or the TX queue refused it */
+} flood_relay_stats_t;
+
+typedef struct {
+    bool     active;
+    uint32_t from_id;
+    uint32_t packet_id;
+    uint32_t due_ms;
+    uint16_t len;
+    uint8_t  frame[FLOOD_FRAME_MAX];
+} flood_relay_t;
+
+/* One probe: returns true if (from_id, packet_id) was seen within
+ * FLOOD_DEDUP_MAX_AGE_MS; otherwise records it and returns false. */
+bool flood_check_and_insert(uint32_t from_id, uint32_t packet_id, uint32_t now_ms);
 
-/* Remember (from_id, packet_id) for deduplication. Call on successful receive. */
-void flood_seen(uint32_t from_id, uint32_t packet_id);
+/* Remember (from_id, packet_id) for deduplication (e.g. our own TX). */
+void flood_seen(uint32_t from_id, uint32_t packet_id, uint32_t now_ms);
 
-/* Check if this packet was already seen */
-bool flood_was_seen(uint32_t from_id, uint32_t packet_id);
+/* Check if this packet was already seen (no insert) */
+bool flood_was_seen(uint32_t from_id, uint32_t packet_id, uint32_t now_ms);
+
+/* Counters; occupancy is computed at now_ms. */
+void flood_get_stats(flood_dedup_stats_t *out, uint32_t now_ms);
 
 /* Prepare packet for relay: decrement hop_limit in buffer, update relay. */
 void flood_prepare_forward(uint8_t *lora_packet, uint16_t len, uint8_t my_node_id);
 
+/* Slot time from the modem settings: 8.5 symbols + radio turnaround (ms). */
+void flood_set_modem(uint8_t sf, uint32_t bw_hz);
+
+/* Relay delay for a frame received at snr (dB); rnd is any random word. */
+uint32_t flood_relay_delay_ms(int8_t snr, uint32_t rnd);
+
+/* Copy the frame, apply flood_prepare_forward to the copy and hold it for
+ * flood_relay_delay_ms(). Returns false if no relay slot is free. */
+bool flood_schedule_relay(const uint8_t *lora_packet, uint16_t len, int8_t snr,
+                          uint8_t my_node_id, uint32_t rnd, uint32_t now_ms);
+
+/* A duplicate of (from_id, packet_id) was heard: cancel our pending relay. */
+void flood_on_duplicate(uint32_t from_id, uint32_t packet_id);
+
+/* Earliest relay whose slot has come, or NULL. Hand r->frame to the TX queue,
+ * then free the slot with flood_relay_done(r, queued): a relay the queue
+ * refused counts as dropped. */
+flood_relay_t *flood_due_relay(uint32_t now_ms);
+void flood_relay_done(flood_relay_t *r, bool queued);
+
+/* ms until the earliest pending relay is due (0 = now); false if none. */
+bool flood_next_relay_ms(uint32_t now_ms, uint32_t *in_ms);
+
+void flood_get_relay_stats(flood_relay_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,196 @@
+/**
+ * Meshtastic Data encoder.
+ */
+
+#include "mesh_data.h"
+#include <string.h>
+
+#if defined(USE_NANOPB)
+
+#include <pb_encode.h>
+#include "meshtastic/data.pb.h"
+
+/* payload is a callback field: stream it from the caller's buffer */
+static bool encode_payload(pb_ostream_t *stream, const pb_field_t *field, void *const *arg) {
+    const mesh_data_t *d = (const mesh_data_t *)*arg;
+    if (d->payload_len == 0) return true;
+    return pb_encode_tag_for_field(stream, field) &&
+           pb_encode_string(stream, d->payload, d->payload_len);
+}
+
+uint16_t mesh_data_encode(const mesh_data_t *d, uint8_t *out, uint16_t max_out) {
+    if (!d || !out || d->payload_len > MESH_DATA_PAYLOAD_MAX) return 0;
+    meshtastic_Data msg = meshtastic_Data_init_zero;
+    msg.portnum = (meshtastic_PortNum)d->portnum;
+    msg.payload.funcs.encode = encode_payload;
+    msg.payload.arg = (void *)d;
+    msg.want_response = d->want_response;
+    msg.dest = d->dest;
+    msg.source = d->source;
+    msg.request_id = d->request_id;
+    msg.reply_id = d->reply_id;
+    msg.emoji = d->emoji;
+    msg.has_bitfield = d->has_bitfield;
+    msg.bitfield = d->bitfield;
+
+    pb_ostream_t stream = pb_ostream_from_buffer(out, max_out);
+    if (!pb_encode(&stream, meshtastic_Data_fields, &msg)) return 0;
+    return (uint16_t)stream.bytes_written;
+}
+
+#else /* !USE_NANOPB: same wire output as the generated encoder */
+
+typedef struct {
+    uint8_t *out;
+    uint16_t max;
+    uint16_t pos;
+    bool     ok;
+} enc_t;
+
+static void put_byte(enc_t *e, uint8_t b) {
+    if (e->pos >= e->max) { e->ok = false; return; }
+    e->out[e->pos++] = b;
+}
+
+static void put_varint(enc_t *e, uint32_t v) {
+    while (v >= 0x80) {
+        put_byte(e, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    put_byte(e, (uint8_t)v);
+}
+
+/* tag = (field << 3) | wire type; all Data tags fit in one byte */
+static void put_fixed32(enc_t *e, uint8_t field, uint32_t v) {
+    if (v == 0) return;
+    put_byte(e, (uint8_t)((field << 3) | 5));
+    put_byte(e, (uint8_t)v);
+    put_byte(e, (uint8_t)(v >> 8));
+    put_byte(e, (uint8_t)(v >> 16));
+    put_byte(e, (uint8_t)(v >> 24));
+}
+
+uint16_t mesh_data_encode(const mesh_data_t *d, uint8_t *out, uint16_t max_out) {
+    if (!d || !out || d->payload_len > MESH_DATA_PAYLOAD_MAX) return 0;
+    enc_t e = { out, max_out, 0, true };
+
+    if (d->portnum) {
+        put_byte(&e, (1 << 3) | 0);
+        put_varint(&e, d->portnum);
+    }
+    if (d->payload_len) {
+        put_byte(&e, (2 << 3) | 2);
+        put_varint(&e, d->payload_len);
+        if (e.ok && d->payload_len <= (uint16_t)(e.max - e.pos)) {
+            memcpy(e.out + e.pos, d->payload, d->payload_len);
+            e.pos = (uint16_t)(e.pos + d->payload_len);
+        } else {
+            e.ok = false;
+        }
+    }
+    if (d->want_response) {
+        put_byte(&e, (3 << 3) | 0);
+        put_byte(&e, 1);
+    }
+    put_fixed32(&e, 4, d->dest);
+    put_fixed32(&e, 5, d->source);
+    put_fixed32(&e, 6, d->request_id);
+    put_fixed32(&e, 7, d->reply_id);
+    put_fixed32(&e, 8, d->emoji);
+    if (d->has_bitfield) {
+        put_byte(&e, (9 << 3) | 0);
+        put_varint(&e, d->bitfield);
+    }
+    return e.ok ? e.pos : 0;
+}
+
+#endif /* USE_NANOPB */
+
+/* --- Decoder (shared by both builds) --- */
+
+/* Protobuf wire types */
+#define WT_VARINT   0
+#define WT_FIXED64  1
+#define WT_LEN      2
+#define WT_FIXED32  5
+
+/* Wire type of each Data field, or 0xFF for fields we don't know */
+static uint8_t data_field_wire(uint32_t field) {
+    switch (field) {
+    case 1: case 3: case 9:                 return WT_VARINT;
+    case 2:                                 return WT_LEN;
+    case 4: case 5: case 6: case 7: case 8: return WT_FIXED32;
+    default:                                return 0xFF;
+    }
+}
+
+/* Up to 10 bytes (a 64-bit varint); bits above 32 are dropped */
+static bool get_varint(const uint8_t *buf, uint16_t len, uint16_t *pos, uint32_t *v) {
+    uint32_t val = 0;
+    for (unsigned i = 0; i < 10; i++) {
+        if (*pos >= len) return false;
+        uint8_t b = buf[(*pos)++];
+        if (i < 5) val |= (uint32_t)(b & 0x7F) << (7 * i);
+        if (!(b & 0x80)) {
+            *v = val;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool mesh_data_decode(const uint8_t *buf, uint16_t len, mesh_data_t *d) {
+    if (!d) return false;
+    memset(d, 0, sizeof(*d));
+    if (!buf && len) return false;
+
+    uint16_t pos = 0;
+    while (pos < len) {
+        uint32_t tag, v;
+        if (!get_varint(buf, len, &pos, &tag)) return false;
+        uint32_t field = tag >> 3;
+        uint8_t wire = (uint8_t)(tag & 7);
+        if (field == 0) return false;
+        uint8_t want = data_field_wire(field);
+        if (want != 0xFF && want != wire) return false;
+
+        switch (wire) {
+        case WT_VARINT:
+            if (!get_varint(buf, len, &pos, &v)) return false;
+            if (field == 1) d->portnum = (uint16_t)v;
+            else if (field == 3) d->want_response = (v != 0);
+            else if (field == 9) { d->has_bitfield = true; d->bitfield = v; }
+            break;
+        case WT_LEN:
+            if (!get_varint(buf, len, &pos, &v)) return false;
+            if (v > (uint32_t)(len - pos)) return false;
+            if (field == 2) {
+                d->payload = buf + pos;
+                d->payload_len = (uint16_t)v;
+            }
+            pos = (uint16_t)(pos + v);
+            break;
+        case WT_FIXED32:
+            if (len - pos < 4) return false;
+            v = (uint32_t)buf[pos] | ((uint32_t)buf[pos + 1] << 8) |
+                ((uint32_t)buf[pos + 2] << 16) | ((uint32_t)buf[pos + 3] << 24);
+            pos = (uint16_t)(pos + 4);
+            switch (field) {
+            case 4: d->dest = v; break;
+            case 5: d->source = v; break;
+            case 6: d->request_id = v; break;
+            case 7: d->reply_id = v; break;
+            case 8: d->emoji = v; break;
+            default: break;
+            }
+            break;
+        case WT_FIXED64:
+            if (len - pos < 8) return false;
+            pos = (uint16_t)(pos + 8);
+            break;
+        default:                            /* groups (3, 4) and reserved 6, 7 */
+            return false;
+        }
+    }
+    return true;
+}
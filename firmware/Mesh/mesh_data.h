@@ -0,0 +1,57 @@
+/**
+ * Meshtastic Data message (portnum + payload + reply metadata): the protobuf
+ * carried, encrypted, after the 16-byte LoRa header.
+ * Encoding writes straight into the frame buffer; with USE_NANOPB it goes
+ * through the generated meshtastic_Data descriptor (Protobuf/meshtastic),
+ * otherwise through an equivalent hand-written encoder.
+ * Decoding is a single bounds-checked pass that fills a view pointing into
+ * the (decrypted) frame; nothing is copied or allocated.
+ */
+
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MESH_MAX_FRAME         255   /* SX126x FIFO / LoRa PHY payload limit */
+#define MESH_DATA_PAYLOAD_MAX  233   /* Meshtastic DATA_PAYLOAD_LEN */
+
+#define MESH_PORTNUM_TEXT_MESSAGE  1
+
+/* Field 0 / false / NULL = not sent (proto3 defaults). As a decode result,
+ * payload points into the decoded buffer. */
+typedef struct {
+    uint16_t       portnum;
+    const uint8_t *payload;
+    uint16_t       payload_len;
+    bool           want_response;
+    uint32_t       dest;
+    uint32_t       source;
+    uint32_t       request_id;
+    uint32_t       reply_id;
+    uint32_t       emoji;
+    bool           has_bitfield;
+    uint32_t       bitfield;
+} mesh_data_t;
+
+/* Encode d into out[0..max_out). Returns the encoded length, 0 if it does not
+ * fit or the payload exceeds MESH_DATA_PAYLOAD_MAX. The payload is read once,
+ * directly from d->payload. */
+uint16_t mesh_data_encode(const mesh_data_t *d, uint8_t *out, uint16_t max_out);
+
+/* Decode buf[0..len) into d. Unknown fields are skipped. Returns false on
+ * malformed input: truncated or over-long varint, length past the end, known
+ * field with the wrong wire type, field 0 or group wire types. Runs in O(len)
+ * and never reads outside buf. */
+bool mesh_data_decode(const uint8_t *buf, uint16_t len, mesh_data_t *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MESH_DATA_H */
@@ -35,6 +35,11 @@ static inline uint8_t mesh_hop_limit(uint8_t flags) {
     return flags & MESH_HOP_LIMIT_MASK;
 }
 
+/* Meshtastic flags layout: hop limit bits 0-2, WantAck 0x08, HopStart bits 5-7 */
+#define MESH_FLAG_WANT_ACK    0x08
+#define MESH_HOP_LIMIT_MAX    7
+#define MESH_HOP_START_SHIFT  5
+
 #ifdef __cplusplus
 }
 #endif
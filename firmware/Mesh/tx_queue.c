@@ -0,0 +1,163 @@
+/**
+ * TX queue: small array scanned linearly (depth is single digits), entries
+ * ordered by (prio, seq). One reservation may be open at a time. There is
+ * one slot more than TX_QUEUE_DEPTH, so a reservation always has a free
+ * buffer: when the queue is full, the victim is only chosen at reserve time
+ * and evicted at commit, so an aborted frame costs nothing.
+ */
+
+#include "tx_queue.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Default time-to-live per class (ms) */
+static const uint32_t prio_ttl_ms[TXQ_PRIO_COUNT] = {
+    [TXQ_PRIO_ACK]   = 5000,
+    [TXQ_PRIO_RELAY] = 10000,
+    [TXQ_PRIO_APP]   = 30000,
+};
+
+#define SLOTS (TX_QUEUE_DEPTH + 1)
+
+static tx_queue_entry_t entries[SLOTS];
+static tx_queue_entry_t *reserved;
+static tx_queue_entry_t *victim;        /* evicted when the reservation commits */
+static tx_queue_entry_t *next_out;
+static uint32_t next_seq;
+static txq_policy_t policy = TXQ_DROP_LOWEST;
+static tx_queue_stats_t stats;
+
+static uint8_t queue_depth(void) {
+    uint8_t n = 0;
+    for (uint32_t i = 0; i < SLOTS; i++)
+        if (entries[i].active) n++;
+    return n;
+}
+
+void tx_queue_init(void) {
+    memset(entries, 0, sizeof(entries));
+    memset(&stats, 0, sizeof(stats));
+    reserved = NULL;
+    victim = NULL;
+    next_out = NULL;
+    next_seq = 0;
+}
+
+void tx_queue_set_policy(txq_policy_t p) {
+    policy = p;
+}
+
+/* Pick the entry to evict for a new frame of class prio, or NULL to refuse it. */
+static tx_queue_entry_t *pick_victim(txq_prio_t prio) {
+    tx_queue_entry_t *v = NULL;
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        tx_queue_entry_t *e = &entries[i];
+        if (!e->active || e == next_out) continue;
+        if (!v) { v = e; continue; }
+        if (policy == TXQ_DROP_LOWEST && e->prio != v->prio) {
+            if (e->prio > v->prio) v = e;
+        } else if ((int32_t)(e->seq - v->seq) < 0) {
+            v = e;
+        }
+    }
+    /* DROP_LOWEST never sacrifices a more important frame for a less important one */
+    if (v && policy == TXQ_DROP_LOWEST && v->prio < prio) return NULL;
+    return v;
+}
+
+uint8_t *tx_queue_reserve(txq_prio_t prio, uint32_t now_ms, uint32_t ttl_ms) {
+    if (prio >= TXQ_PRIO_COUNT || reserved) return NULL;
+    victim = NULL;
+    if (queue_depth() >= TX_QUEUE_DEPTH) {
+        victim = pick_victim(prio);
+        if (!victim) {
+            stats.rejected++;
+            return NULL;
+        }
+    }
+    tx_queue_entry_t *slot = NULL;
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        if (!entries[i].active) { slot = &entries[i]; break; }
+    }
+    if (!slot) return NULL;
+    slot->prio = prio;
+    slot->deadline_ms = now_ms + (ttl_ms ? ttl_ms : prio_ttl_ms[prio]);
+    slot->len = 0;
+    reserved = slot;
+    return slot->frame;
+}
+
+void tx_queue_commit(uint16_t len) {
+    if (!reserved) return;
+    if (len == 0 || len > TX_QUEUE_FRAME_MAX) {
+        reserved = NULL;
+        victim = NULL;
+        return;
+    }
+    if (victim && victim->active) {
+        victim->active = false;
+        stats.evicted++;
+        victim = NULL;
+    }
+    reserved->len = len;
+    reserved->seq = next_seq++;
+    reserved->active = true;
+    reserved = NULL;
+    stats.enqueued++;
+    uint8_t d = queue_depth();
+    if (d > stats.high_water) stats.high_water = d;
+}
+
+void tx_queue_abort(void) {
+    reserved = NULL;
+    victim = NULL;
+}
+
+bool tx_queue_push(const uint8_t *frame, uint16_t len, txq_prio_t prio,
+                   uint32_t now_ms, uint32_t ttl_ms)
+{
+    if (!frame || len == 0 || len > TX_QUEUE_FRAME_MAX) return false;
+    uint8_t *buf = tx_queue_reserve(prio, now_ms, ttl_ms);
+    if (!buf) return false;
+    memcpy(buf, frame, len);
+    tx_queue_commit(len);
+    return true;
+}
+
+const tx_queue_entry_t *tx_queue_next(uint32_t now_ms) {
+    tx_queue_entry_t *best = NULL;
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        tx_queue_entry_t *e = &entries[i];
+        if (!e->active) continue;
+        if ((int32_t)(now_ms - e->deadline_ms) >= 0) {
+            e->active = false;
+            stats.expired++;
+            continue;
+        }
+        if (!best || e->prio < best->prio ||
+            (e->prio == best->prio && (int32_t)(e->seq - best->seq) < 0))
+            best = e;
+    }
+    next_out = best;
+    return best;
+}
+
+void tx_queue_pop(bool sent) {
+    if (!next_out) return;
+    next_out->active = false;
+    next_out = NULL;
+    if (sent) stats.sent++;
+    else stats.failed++;
+}
+
+void tx_queue_get_stats(tx_queue_stats_t *out) {
+    if (!out) return;
+    memcpy(out, &stats, sizeof(*out));
+    memset(out->depth_by_prio, 0, sizeof(out->depth_by_prio));
+    out->depth = 0;
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        if (!entries[i].active) continue;
+        out->depth++;
+        out->depth_by_prio[entries[i].prio]++;
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * Outgoing LoRa frame queue: bounded, three priority classes, per-entry
+ * deadline, configurable overflow policy. The main loop feeds the radio one
+ * frame at a time from tx_queue_next(); producers build frames in place in a
+ * reserved slot (no staging buffer).
+ */
+
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TX_QUEUE_DEPTH
+#define TX_QUEUE_DEPTH   6
+#endif
+#define TX_QUEUE_FRAME_MAX  256
+
+/* Lower value = sent first. FIFO within a class. */
+typedef enum {
+    TXQ_PRIO_ACK,       /* ACK / routing / auto-reply */
+    TXQ_PRIO_RELAY,     /* flood relays */
+    TXQ_PRIO_APP,       /* locally originated app traffic (UART text) */
+    TXQ_PRIO_COUNT
+} txq_prio_t;
+
+typedef enum {
+    TXQ_DROP_LOWEST,    /* evict the oldest entry of the lowest class (default) */
+    TXQ_DROP_OLDEST,    /* evict the oldest entry regardless of class */
+} txq_policy_t;
+
+typedef struct {
+    uint8_t    frame[TX_QUEUE_FRAME_MAX];  /* first: word-aligned for in-place AES */
+    uint32_t   seq;          /* enqueue order */
+    uint32_t   deadline_ms;  /* dropped if still queued at this time */
+    txq_prio_t prio;
+    uint16_t   len;
+    bool       active;
+} tx_queue_entry_t;
+
+typedef struct {
+    uint32_t enqueued;
+    uint32_t sent;           /* handed to the radio */
+    uint32_t failed;         /* radio refused the frame */
+    uint32_t rejected;       /* new frame refused: queue full of higher-priority frames */
+    uint32_t evicted;        /* queued frame dropped to make room */
+    uint32_t expired;        /* deadline passed before TX */
+    uint8_t  depth;
+    uint8_t  high_water;
+    uint8_t  depth_by_prio[TXQ_PRIO_COUNT];
+} tx_queue_stats_t;
+
+void tx_queue_init(void);
+void tx_queue_set_policy(txq_policy_t policy);
+
+/* Reserve a slot and return its frame buffer (TX_QUEUE_FRAME_MAX bytes); NULL
+ * if the queue is full and the policy refuses the frame. ttl_ms = 0 uses the
+ * class default. Finish with tx_queue_commit(len), which evicts a queued frame
+ * per policy if the queue is full, or tx_queue_abort(), which leaves the
+ * queue as it was. */
+uint8_t *tx_queue_reserve(txq_prio_t prio, uint32_t now_ms, uint32_t ttl_ms);
+void tx_queue_commit(uint16_t len);
+void tx_queue_abort(void);
+
+/* reserve + copy + commit */
+bool tx_queue_push(const uint8_t *frame, uint16_t len, txq_prio_t prio,
+                   uint32_t now_ms, uint32_t ttl_ms);
+
+/* Next frame to send (drops expired entries first), or NULL. tx_queue_pop()
+ * removes it once the radio has accepted (sent = true) or refused it. */
+const tx_queue_entry_t *tx_queue_next(uint32_t now_ms);
+void tx_queue_pop(bool sent);
+
+void tx_queue_get_stats(tx_queue_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TX_QUEUE_H */
@@ -0,0 +1,116 @@
+/**
+ * Time-on-air (SX126x DS 6.1.4) and one-hour sliding duty-cycle window.
+ */
+
+#include "lora_airtime.h"
+#include <string.h>
+
+uint32_t lora_time_on_air_us(uint8_t sf, uint32_t bw_hz, uint8_t cr,
+                             uint16_t preamble_len, uint16_t payload_len)
+{
+    if (sf < 5 || sf > 12 || bw_hz == 0) return 0;
+    uint32_t cr_idx = (cr < 5) ? 1u : (cr > 8 ? 4u : (uint32_t)cr - 4u);
+    bool ldro = (sf >= 11 && bw_hz <= 125000);     /* same rule as the driver */
+
+    /* Payload symbols: explicit header (20 bits), 16-bit CRC */
+    int32_t bits;
+    uint32_t bits_per_sym;
+    uint32_t extra_q;                               /* fixed preamble part, quarter symbols */
+    if (sf <= 6) {
+        bits = 8 * (int32_t)payload_len + 16 - 4 * (int32_t)sf + 20;
+        bits_per_sym = 4u * sf;
+        extra_q = 25;                               /* 6.25 */
+    } else {
+        bits = 8 * (int32_t)payload_len + 16 - 4 * (int32_t)sf + 8 + 20;
+        bits_per_sym = 4u * (ldro ? sf - 2u : sf);
+        extra_q = 17;                               /* 4.25 */
+    }
+    uint32_t blocks = bits > 0 ? ((uint32_t)bits + bits_per_sym - 1u) / bits_per_sym : 0;
+    uint32_t nsym = preamble_len + 8u + blocks * (cr_idx + 4u);
+
+    /* T = nsym_q/4 * 2^SF / BW */
+    uint64_t nsym_q = (uint64_t)nsym * 4u + extra_q;
+    return (uint32_t)((nsym_q * ((uint64_t)1000000u << sf) + 4u * bw_hz - 1u) / (4u * (uint64_t)bw_hz));
+}
+
+uint32_t lora_time_on_air_ms(uint8_t sf, uint32_t bw_hz, uint8_t cr,
+                             uint16_t preamble_len, uint16_t payload_len)
+{
+    return (lora_time_on_air_us(sf, bw_hz, cr, preamble_len, payload_len) + 999u) / 1000u;
+}
+
+uint16_t lora_duty_limit_permille(uint32_t freq_hz, bool eu_rules) {
+    if (!eu_rules) return 0;
+    if (freq_hz >= 863000000u && freq_hz <= 870000000u) {
+        if (freq_hz >= 869400000u && freq_hz <= 869650000u) return 100;   /* g3 */
+        return 10;
+    }
+    if (freq_hz >= 433050000u && freq_hz <= 434790000u) return 100;
+    return 0;
+}
+
+/* ---- Sliding window ---- */
+
+static uint32_t bucket_ms[LORA_DUTY_BUCKETS];
+static uint32_t bucket_minute[LORA_DUTY_BUCKETS];   /* absolute minute stamp */
+static uint16_t s_limit;
+static uint32_t s_charged;
+static uint32_t s_deferred;
+static bool s_blocked;
+
+void lora_duty_init(uint16_t limit_permille) {
+    memset(bucket_ms, 0, sizeof(bucket_ms));
+    memset(bucket_minute, 0xFF, sizeof(bucket_minute));
+    s_limit = limit_permille;
+    s_charged = 0;
+    s_deferred = 0;
+    s_blocked = false;
+}
+
+void lora_duty_set_limit(uint16_t limit_permille) {
+    s_limit = limit_permille;
+}
+
+static uint32_t window_used_ms(uint32_t now_ms) {
+    uint32_t minute = now_ms / LORA_DUTY_BUCKET_MS;
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < LORA_DUTY_BUCKETS; i++) {
+        if ((uint32_t)(minute - bucket_minute[i]) < LORA_DUTY_BUCKETS)
+            used += bucket_ms[i];
+    }
+    return used;
+}
+
+static uint32_t budget_ms(void) {
+    return (uint32_t)((uint64_t)LORA_DUTY_WINDOW_MS * s_limit / 1000u);
+}
+
+bool lora_duty_allows(uint32_t airtime_ms, uint32_t now_ms) {
+    if (s_limit == 0 || window_used_ms(now_ms) + airtime_ms <= budget_ms()) {
+        s_blocked = false;
+        return true;
+    }
+    if (!s_blocked) s_deferred++;   /* once per blocked stretch, not per poll */
+    s_blocked = true;
+    return false;
+}
+
+void lora_duty_charge(uint32_t airtime_ms, uint32_t now_ms) {
+    uint32_t minute = now_ms / LORA_DUTY_BUCKET_MS;
+    uint32_t i = minute % LORA_DUTY_BUCKETS;
+    if (bucket_minute[i] != minute) {
+        bucket_minute[i] = minute;
+        bucket_ms[i] = 0;
+    }
+    bucket_ms[i] += airtime_ms;
+    s_charged += airtime_ms;
+}
+
+void lora_duty_get_stats(lora_duty_stats_t *out, uint32_t now_ms) {
+    if (!out) return;
+    out->limit_permille = s_limit;
+    out->budget_ms = budget_ms();
+    out->used_ms = window_used_ms(now_ms);
+    out->charged_ms = s_charged;
+    out->deferred = s_deferred;
+}
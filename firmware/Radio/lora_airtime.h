@@ -0,0 +1,61 @@
+/**
+ * LoRa time-on-air and regulatory duty-cycle budget (HAL-free).
+ * Time-on-air follows the SX126x datasheet (6.1.4) for the packet format used
+ * on air here: explicit header, CRC on, Meshtastic preamble. The budget is a
+ * sliding window of one-minute buckets over one hour.
+ */
+
+#ifndef LORA_AIRTIME_H
+#define LORA_AIRTIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Meshtastic preamble length (symbols); the driver programs the same value */
+#define MESHTASTIC_LORA_PREAMBLE_LEN  16
+
+#define LORA_DUTY_WINDOW_MS   3600000u          /* 1 h */
+#define LORA_DUTY_BUCKET_MS   60000u            /* 1 min */
+/* One extra bucket for the partial current minute: the window never comes up short */
+#define LORA_DUTY_BUCKETS     (LORA_DUTY_WINDOW_MS / LORA_DUTY_BUCKET_MS + 1u)
+
+/* Exact on-air duration (µs) of a frame of payload_len bytes.
+ * cr = 5..8 (4/5..4/8); LowDataRateOptimize as programmed by the driver. */
+uint32_t lora_time_on_air_us(uint8_t sf, uint32_t bw_hz, uint8_t cr,
+                             uint16_t preamble_len, uint16_t payload_len);
+
+/* Same, rounded up to whole milliseconds. */
+uint32_t lora_time_on_air_ms(uint8_t sf, uint32_t bw_hz, uint8_t cr,
+                             uint16_t preamble_len, uint16_t payload_len);
+
+/* Duty-cycle limit in permille for a channel: EU868 10 ‰ (100 ‰ in the
+ * 869.4–869.65 MHz sub-band), EU433 100 ‰; 0 = no limit. */
+uint16_t lora_duty_limit_permille(uint32_t freq_hz, bool eu_rules);
+
+typedef struct {
+    uint16_t limit_permille;   /* 0 = unlimited */
+    uint32_t budget_ms;        /* allowed airtime per window */
+    uint32_t used_ms;          /* airtime in the current window */
+    uint32_t charged_ms;       /* total airtime since init */
+    uint32_t deferred;         /* times TX was held back for lack of budget */
+} lora_duty_stats_t;
+
+void lora_duty_init(uint16_t limit_permille);
+void lora_duty_set_limit(uint16_t limit_permille);
+
+/* true if airtime_ms fits in the remaining budget. Cheap enough to poll. */
+bool lora_duty_allows(uint32_t airtime_ms, uint32_t now_ms);
+/* Record airtime of a started TX. */
+void lora_duty_charge(uint32_t airtime_ms, uint32_t now_ms);
+
+void lora_duty_get_stats(lora_duty_stats_t *out, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LORA_AIRTIME_H */
@@ -4,6 +4,7 @@
 
 #include "lora_meshtastic.h"
 #include "radio_phy.h"
+#include "lora_airtime.h"
 #include <string.h>
 
 /* Default frequency for region (first slot), Hz */
@@ -27,7 +28,21 @@ static const modem_preset_t modem_presets[MODEM_COUNT] = {
 };
 
 static lora_params_t s_params;
+static lora_region_t s_region = REGION_EU_868;
 static bool s_inited;
+static bool s_lbt_enabled = true;
+
+/* LBT slot follows the modem: one slot ≈ one 2-symbol CAD */
+static void apply_lbt(void) {
+    radio_lbt_config_t cfg = {
+        .enabled      = s_lbt_enabled,
+        .max_attempts = RADIO_LBT_MAX_ATTEMPTS,
+        .cw_min       = RADIO_LBT_CW_MIN,
+        .cw_max       = RADIO_LBT_CW_MAX,
+        .slot_ms      = radio_lbt_slot_ms(s_params.sf, s_params.bw_hz),
+    };
+    radio_phy_set_lbt(&cfg);
+}
 
 bool lora_init(void) {
     if (s_inited) return true;
@@ -35,20 +50,26 @@ bool lora_init(void) {
     s_params.sf = 11;
     s_params.bw_hz = 250000;
     s_params.cr = 5;
+    lora_duty_init(lora_duty_limit_permille(s_params.freq_hz, true));
     if (!radio_phy_init()) return false;
+    apply_lbt();
     s_inited = true;
     return true;
 }
 
 bool lora_set_region_preset(lora_region_t region, lora_modem_preset_t preset) {
     if (region >= REGION_COUNT || preset >= MODEM_COUNT) return false;
+    s_region = region;
     s_params.freq_hz = region_freq_default[region];
+    lora_duty_set_limit(lora_duty_limit_permille(s_params.freq_hz,
+                        region == REGION_EU_868 || region == REGION_EU_433));
     const modem_preset_t *m = &modem_presets[preset];
     s_params.sf = m->sf;
     s_params.bw_hz = m->bw;
     s_params.cr = m->cr;
-    if (!radio_phy_set_freq(s_params.freq_hz)) return false;
-    if (!radio_phy_set_lora(s_params.sf, s_params.bw_hz, s_params.cr)) return false;
+    if (!radio_phy_tune(s_params.freq_hz, s_params.sf, s_params.bw_hz, s_params.cr))
+        return false;
+    apply_lbt();
     return true;
 }
 
@@ -56,14 +77,38 @@ void lora_get_params(lora_params_t *out) {
     if (out) memcpy(out, &s_params, sizeof(s_params));
 }
 
+lora_region_t lora_get_region(void) {
+    return s_region;
+}
+
+uint32_t lora_airtime_ms(uint16_t len) {
+    return lora_time_on_air_ms(s_params.sf, s_params.bw_hz, s_params.cr,
+                               MESHTASTIC_LORA_PREAMBLE_LEN, len);
+}
+
 bool lora_tx(const uint8_t *data, uint16_t len) {
     if (!data) return false;
-    return radio_phy_tx(data, len);
+    return radio_phy_tx_start(data, len);
+}
+
+bool lora_tx_busy(void) {
+    return radio_phy_tx_busy();
+}
+
+void lora_set_tx_done_cb(radio_tx_done_cb_t cb) {
+    radio_phy_set_tx_done_cb(cb);
+}
+
+void lora_service(void) {
+    radio_phy_service();
+}
+
+radio_rx_frame_t *lora_rx_borrow(void) {
+    return radio_phy_rx_borrow();
 }
 
-uint16_t lora_rx_poll(uint8_t *buf, uint16_t max_len) {
-    if (!buf || max_len == 0) return 0;
-    return radio_phy_rx_poll(buf, max_len);
+void lora_rx_release(void) {
+    radio_phy_rx_release();
 }
 
 int16_t lora_last_rssi(void) {
@@ -77,3 +122,37 @@ int8_t lora_last_snr(void) {
     radio_phy_get_last_rssi_snr(&r, &s);
     return s;
 }
+
+void lora_get_rx_stats(radio_rx_stats_t *out) {
+    radio_phy_get_rx_stats(out);
+}
+
+void lora_set_lbt(bool enabled) {
+    s_lbt_enabled = enabled;
+    apply_lbt();
+}
+
+void lora_get_lbt_stats(radio_lbt_stats_t *out) {
+    radio_phy_get_lbt_stats(out);
+}
+
+void lora_set_boot_hint(const radio_boot_info_t *hint) {
+    radio_phy_set_boot_hint(hint);
+}
+
+void lora_get_boot_info(radio_boot_info_t *out) {
+    radio_phy_get_boot_info(out);
+}
+
+bool lora_set_channel(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz, uint8_t cr) {
+    if (!radio_phy_tune(freq_hz, sf, bw_hz, cr)) return false;
+    bool modem_changed = (sf != s_params.sf || bw_hz != s_params.bw_hz);
+    s_params.freq_hz = freq_hz;
+    s_params.sf = sf;
+    s_params.bw_hz = bw_hz;
+    s_params.cr = cr;
+    lora_duty_set_limit(lora_duty_limit_permille(freq_hz,
+                        s_region == REGION_EU_868 || s_region == REGION_EU_433));
+    if (modem_changed) apply_lbt();
+    return true;
+}
@@ -8,6 +8,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "radio_phy.h"
+#include "lora_airtime.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,22 +46,58 @@ typedef struct {
 /* Init radio (SubGHz HAL or RadioLib) */
 bool lora_init(void);
 
+/* Oscillator type and image band from a previous boot (set before lora_init
+ * to skip the TCXO probe); lora_get_boot_info returns what to save for the
+ * next boot. */
+void lora_set_boot_hint(const radio_boot_info_t *hint);
+void lora_get_boot_info(radio_boot_info_t *out);
+
 /* Apply region + modem preset (Meshtastic-style) */
 bool lora_set_region_preset(lora_region_t region, lora_modem_preset_t preset);
 
+/* Retune to an arbitrary channel/modem (scanning, adaptive rate). Only the
+ * settings that differ from the current ones are sent to the radio; a
+ * same-band frequency hop is a single command. Fails while a TX is in flight. */
+bool lora_set_channel(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz, uint8_t cr);
+
 /* Current params (for debug/config) */
 void lora_get_params(lora_params_t *out);
+lora_region_t lora_get_region(void);
+
+/* Time-on-air of a len-byte frame with the current preset (ms, rounded up).
+ * The region's duty-cycle limit is loaded into the lora_duty_* budget by
+ * lora_set_region_preset; the caller checks and charges it around lora_tx. */
+uint32_t lora_airtime_ms(uint16_t len);
 
-/* Transmit: buffer + length. Returns success. */
+/* Start transmit: buffer + length, returns immediately. The buffer may be reused
+ * once this returns. false = radio busy or frame rejected. Completion is reported
+ * through the callback set by lora_set_tx_done_cb (may run in IRQ context). */
 bool lora_tx(const uint8_t *data, uint16_t len);
+bool lora_tx_busy(void);
+void lora_set_tx_done_cb(radio_tx_done_cb_t cb);
 
-/* Non-blocking receive: if packet available, copy to buf and return length; else 0. */
-uint16_t lora_rx_poll(uint8_t *buf, uint16_t max_len);
+/* Driver housekeeping: call from the main loop (TX guard timeout, LBT backoff). */
+void lora_service(void);
+
+/* Non-blocking zero-copy receive: borrow the oldest received frame (NULL if none).
+ * data/len/rssi/snr/rx_ms are valid, and data may be modified in place (decrypt,
+ * header rewrite for relay), until lora_rx_release(). */
+radio_rx_frame_t *lora_rx_borrow(void);
+void lora_rx_release(void);
 
 /* RSSI/SNR of last received packet (optional) */
 int16_t lora_last_rssi(void);
 int8_t  lora_last_snr(void);
 
+/* RX ring counters (received, overflows, driver errors, depth) */
+void lora_get_rx_stats(radio_rx_stats_t *out);
+
+/* Listen-before-talk (CAD before each TX, on by default). The backoff slot is
+ * derived from the current SF/BW. A frame that finds the channel busy too many
+ * times completes with RADIO_TX_CHANNEL_BUSY. */
+void lora_set_lbt(bool enabled);
+void lora_get_lbt_stats(radio_lbt_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,77 @@
+/**
+ * Listen-before-talk: binary exponential backoff over CAD results.
+ */
+
+#include "radio_lbt.h"
+#include <string.h>
+
+static radio_lbt_config_t s_cfg;
+static radio_lbt_stats_t s_stats;
+static uint8_t  s_attempt;
+static uint16_t s_cw;
+
+void radio_lbt_init(void) {
+    s_cfg.enabled = true;
+    s_cfg.max_attempts = RADIO_LBT_MAX_ATTEMPTS;
+    s_cfg.cw_min = RADIO_LBT_CW_MIN;
+    s_cfg.cw_max = RADIO_LBT_CW_MAX;
+    s_cfg.slot_ms = radio_lbt_slot_ms(11, 250000);
+    memset(&s_stats, 0, sizeof(s_stats));
+    radio_lbt_begin();
+}
+
+void radio_lbt_configure(const radio_lbt_config_t *cfg) {
+    if (!cfg) return;
+    s_cfg = *cfg;
+    if (s_cfg.max_attempts == 0) s_cfg.max_attempts = 1;
+    if (s_cfg.cw_min == 0) s_cfg.cw_min = 1;
+    if (s_cfg.cw_max < s_cfg.cw_min) s_cfg.cw_max = s_cfg.cw_min;
+    if (s_cfg.slot_ms == 0) s_cfg.slot_ms = 1;
+    radio_lbt_begin();
+}
+
+void radio_lbt_get_config(radio_lbt_config_t *out) {
+    if (out) *out = s_cfg;
+}
+
+bool radio_lbt_enabled(void) {
+    return s_cfg.enabled;
+}
+
+void radio_lbt_begin(void) {
+    s_attempt = 0;
+    s_cw = s_cfg.cw_min;
+}
+
+radio_lbt_decision_t radio_lbt_on_cad(bool busy, uint32_t rnd, uint32_t *backoff_ms) {
+    s_stats.cad_runs++;
+    if (!busy) return RADIO_LBT_CLEAR;
+
+    s_stats.cad_busy++;
+    if (++s_attempt >= s_cfg.max_attempts) {
+        s_stats.give_ups++;
+        return RADIO_LBT_GIVE_UP;
+    }
+
+    /* 1..cw slots (never 0: the other node's packet is still on air) */
+    uint32_t ms = (rnd % s_cw + 1u) * s_cfg.slot_ms;
+    if (s_cw < s_cfg.cw_max) {
+        s_cw = (uint16_t)(s_cw * 2u);
+        if (s_cw > s_cfg.cw_max) s_cw = s_cfg.cw_max;
+    }
+    s_stats.backoffs++;
+    s_stats.backoff_ms += ms;
+    if (backoff_ms) *backoff_ms = ms;
+    return RADIO_LBT_BACKOFF;
+}
+
+void radio_lbt_get_stats(radio_lbt_stats_t *out) {
+    if (out) *out = s_stats;
+}
+
+uint16_t radio_lbt_slot_ms(uint8_t sf, uint32_t bw_hz) {
+    if (bw_hz == 0 || sf < 5 || sf > 12) return 1;
+    /* 2 symbols of (2^SF / BW) plus ~1 ms for mode switching */
+    uint32_t two_sym_ms = ((2000u << sf) + bw_hz - 1u) / bw_hz;
+    return (uint16_t)(two_sym_ms + 1u);
+}
@@ -0,0 +1,72 @@
+/**
+ * Listen-before-talk decision logic (HAL-free).
+ * Before each TX the driver runs CAD and reports the result here; the module
+ * answers "transmit", "back off N ms and try again" (random slots in a
+ * contention window that doubles on every busy CAD) or "give up". A host test
+ * can drive it with a scripted busy/clear sequence and a fixed random input.
+ */
+
+#ifndef RADIO_LBT_H
+#define RADIO_LBT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RADIO_LBT_MAX_ATTEMPTS
+#define RADIO_LBT_MAX_ATTEMPTS  6     /* busy CADs before the frame is dropped */
+#endif
+#ifndef RADIO_LBT_CW_MIN
+#define RADIO_LBT_CW_MIN        4     /* slots */
+#endif
+#ifndef RADIO_LBT_CW_MAX
+#define RADIO_LBT_CW_MAX        64    /* slots */
+#endif
+
+typedef struct {
+    bool     enabled;
+    uint8_t  max_attempts;
+    uint16_t cw_min;       /* initial contention window (slots) */
+    uint16_t cw_max;       /* window cap (slots) */
+    uint16_t slot_ms;      /* one slot ≈ one CAD */
+} radio_lbt_config_t;
+
+typedef enum {
+    RADIO_LBT_CLEAR,       /* channel free: transmit now */
+    RADIO_LBT_BACKOFF,     /* busy: wait *backoff_ms, then CAD again */
+    RADIO_LBT_GIVE_UP,     /* busy max_attempts times: drop the frame */
+} radio_lbt_decision_t;
+
+typedef struct {
+    uint32_t cad_runs;
+    uint32_t cad_busy;
+    uint32_t backoffs;
+    uint32_t backoff_ms;   /* total time spent backing off */
+    uint32_t give_ups;
+} radio_lbt_stats_t;
+
+/* Reset to defaults (enabled, RADIO_LBT_* window, slot for SF11/250 kHz) and clear stats. */
+void radio_lbt_init(void);
+void radio_lbt_configure(const radio_lbt_config_t *cfg);
+void radio_lbt_get_config(radio_lbt_config_t *out);
+bool radio_lbt_enabled(void);
+
+/* Start of a new frame: attempt counter and window back to cw_min. */
+void radio_lbt_begin(void);
+
+/* CAD finished. rnd is any 32-bit random value; *backoff_ms is set for BACKOFF. */
+radio_lbt_decision_t radio_lbt_on_cad(bool busy, uint32_t rnd, uint32_t *backoff_ms);
+
+void radio_lbt_get_stats(radio_lbt_stats_t *out);
+
+/* Slot length for a modem: 2-symbol CAD plus processing margin (ms). */
+uint16_t radio_lbt_slot_ms(uint8_t sf, uint32_t bw_hz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RADIO_LBT_H */
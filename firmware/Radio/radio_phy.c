@@ -3,27 +3,60 @@
  */
 
 #include "radio_phy.h"
+#include <stddef.h>
+#include <string.h>
 
 static const radio_phy_ops_t *s_ops;
+static radio_tx_done_cb_t s_tx_done_cb;
 
 void radio_phy_set_ops(const radio_phy_ops_t *ops) {
     s_ops = ops;
 }
 
+void radio_phy_set_tx_done_cb(radio_tx_done_cb_t cb) {
+    s_tx_done_cb = cb;
+}
+
+void radio_phy_notify_tx_done(radio_tx_result_t result) {
+    if (s_tx_done_cb) s_tx_done_cb(result);
+}
+
 static bool default_init(void) { (void)0; return true; }
 static bool default_set_freq(uint32_t f) { (void)f; return true; }
 static bool default_set_lora(uint8_t a, uint32_t b, uint8_t c) { (void)a;(void)b;(void)c; return true; }
-static bool default_tx(const uint8_t *d, uint16_t l) { (void)d;(void)l; return true; }
-static uint16_t default_rx_poll(uint8_t *b, uint16_t m) { (void)b;(void)m; return 0; }
+static bool default_tune(uint32_t f, uint8_t a, uint32_t b, uint8_t c) { (void)f;(void)a;(void)b;(void)c; return true; }
+static bool default_tx_start(const uint8_t *d, uint16_t l) {
+    (void)d;(void)l;
+    radio_phy_notify_tx_done(RADIO_TX_OK);
+    return true;
+}
+static bool default_tx_busy(void) { return false; }
+static void default_service(void) { (void)0; }
+static radio_rx_frame_t *default_rx_borrow(void) { return NULL; }
+static void default_rx_release(void) { (void)0; }
 static void default_rssi_snr(int16_t *r, int8_t *s) { if (r) *r = 0; if (s) *s = 0; }
+static void default_rx_stats(radio_rx_stats_t *o) { if (o) memset(o, 0, sizeof(*o)); }
+static bool default_set_lbt(const radio_lbt_config_t *c) { (void)c; return false; }
+static void default_lbt_stats(radio_lbt_stats_t *o) { if (o) memset(o, 0, sizeof(*o)); }
+static void default_set_boot_hint(const radio_boot_info_t *h) { (void)h; }
+static void default_boot_info(radio_boot_info_t *o) { if (o) memset(o, 0, sizeof(*o)); }
 
 static const radio_phy_ops_t default_ops = {
     .init = default_init,
     .set_freq = default_set_freq,
     .set_lora = default_set_lora,
-    .tx = default_tx,
-    .rx_poll = default_rx_poll,
+    .tune = default_tune,
+    .tx_start = default_tx_start,
+    .tx_busy = default_tx_busy,
+    .service = default_service,
+    .rx_borrow = default_rx_borrow,
+    .rx_release = default_rx_release,
     .get_last_rssi_snr = default_rssi_snr,
+    .get_rx_stats = default_rx_stats,
+    .set_lbt = default_set_lbt,
+    .get_lbt_stats = default_lbt_stats,
+    .set_boot_hint = default_set_boot_hint,
+    .get_boot_info = default_boot_info,
 };
 
 bool radio_phy_init(void) {
@@ -41,17 +74,62 @@ bool radio_phy_set_lora(uint8_t sf, uint32_t bw_hz, uint8_t cr) {
     return ops->set_lora(sf, bw_hz, cr);
 }
 
-bool radio_phy_tx(const uint8_t *data, uint16_t len) {
+bool radio_phy_tune(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz, uint8_t cr) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    return ops->tune(freq_hz, sf, bw_hz, cr);
+}
+
+bool radio_phy_tx_start(const uint8_t *data, uint16_t len) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    return ops->tx_start(data, len);
+}
+
+bool radio_phy_tx_busy(void) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    return ops->tx_busy();
+}
+
+void radio_phy_service(void) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    ops->service();
+}
+
+radio_rx_frame_t *radio_phy_rx_borrow(void) {
     const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
-    return ops->tx(data, len);
+    return ops->rx_borrow();
 }
 
-uint16_t radio_phy_rx_poll(uint8_t *buf, uint16_t max_len) {
+void radio_phy_rx_release(void) {
     const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
-    return ops->rx_poll(buf, max_len);
+    ops->rx_release();
 }
 
 void radio_phy_get_last_rssi_snr(int16_t *rssi, int8_t *snr) {
     const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
     ops->get_last_rssi_snr(rssi, snr);
 }
+
+void radio_phy_get_rx_stats(radio_rx_stats_t *out) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    ops->get_rx_stats(out);
+}
+
+bool radio_phy_set_lbt(const radio_lbt_config_t *cfg) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    return ops->set_lbt(cfg);
+}
+
+void radio_phy_get_lbt_stats(radio_lbt_stats_t *out) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    ops->get_lbt_stats(out);
+}
+
+void radio_phy_set_boot_hint(const radio_boot_info_t *hint) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    ops->set_boot_hint(hint);
+}
+
+void radio_phy_get_boot_info(radio_boot_info_t *out) {
+    const radio_phy_ops_t *ops = s_ops ? s_ops : &default_ops;
+    ops->get_boot_info(out);
+}
@@ -8,30 +8,82 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "radio_rx_queue.h"
+#include "radio_lbt.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef enum {
+    RADIO_TX_OK,
+    RADIO_TX_TIMEOUT,
+    RADIO_TX_CHANNEL_BUSY,   /* listen-before-talk gave up; frame not sent */
+} radio_tx_result_t;
+
+/* Boot facts worth keeping across resets so the next init can skip probing:
+ * which oscillator the TCXO probe found and the image-calibration band. */
+#define RADIO_OSC_UNKNOWN  0
+#define RADIO_OSC_TCXO     1
+#define RADIO_OSC_XTAL     2
+
+typedef struct {
+    uint8_t  osc;            /* RADIO_OSC_* */
+    uint16_t image_cal;      /* CalibrateImage freq1 << 8 | freq2; 0 = unknown */
+} radio_boot_info_t;
+
+/* TX completion callback. May run in radio IRQ context — keep it short. */
+typedef void (*radio_tx_done_cb_t)(radio_tx_result_t result);
+
 typedef struct {
     bool (*init)(void);
     bool (*set_freq)(uint32_t freq_hz);
     bool (*set_lora)(uint8_t sf, uint32_t bw_hz, uint8_t cr);
-    bool (*tx)(const uint8_t *data, uint16_t len);
-    uint16_t (*rx_poll)(uint8_t *buf, uint16_t max_len);
+    /* Frequency + modem in one retune; only changed settings are sent to the radio */
+    bool (*tune)(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz, uint8_t cr);
+    /* Asynchronous TX: start and return; RX is re-armed by the driver on completion. */
+    bool (*tx_start)(const uint8_t *data, uint16_t len);
+    bool (*tx_busy)(void);
+    /* Main-loop housekeeping (TX guard timeout etc.) */
+    void (*service)(void);
+    /* Zero-copy RX: borrow the oldest received frame (NULL if none). It stays valid
+     * and writable in place until rx_release(); at most one frame is borrowed. */
+    radio_rx_frame_t *(*rx_borrow)(void);
+    void (*rx_release)(void);
     void (*get_last_rssi_snr)(int16_t *rssi, int8_t *snr);
+    void (*get_rx_stats)(radio_rx_stats_t *out);
+    /* Listen-before-talk (CAD + contention-window backoff) before each TX */
+    bool (*set_lbt)(const radio_lbt_config_t *cfg);
+    void (*get_lbt_stats)(radio_lbt_stats_t *out);
+    /* Hint from a previous boot, used by the next init (a wrong hint is
+     * detected and falls back to probing); info reflects the current state. */
+    void (*set_boot_hint)(const radio_boot_info_t *hint);
+    void (*get_boot_info)(radio_boot_info_t *out);
 } radio_phy_ops_t;
 
 /* Set driver (called from lora_init when implementation is present). */
 void radio_phy_set_ops(const radio_phy_ops_t *ops);
 
+/* TX completion: application registers, driver notifies. */
+void radio_phy_set_tx_done_cb(radio_tx_done_cb_t cb);
+void radio_phy_notify_tx_done(radio_tx_result_t result);
+
 /* Call current driver. Weak stubs — if radio_stm32wl is not linked, these are used. */
 bool radio_phy_init(void);
 bool radio_phy_set_freq(uint32_t freq_hz);
 bool radio_phy_set_lora(uint8_t sf, uint32_t bw_hz, uint8_t cr);
-bool radio_phy_tx(const uint8_t *data, uint16_t len);
-uint16_t radio_phy_rx_poll(uint8_t *buf, uint16_t max_len);
+bool radio_phy_tune(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz, uint8_t cr);
+bool radio_phy_tx_start(const uint8_t *data, uint16_t len);
+bool radio_phy_tx_busy(void);
+void radio_phy_service(void);
+radio_rx_frame_t *radio_phy_rx_borrow(void);
+void radio_phy_rx_release(void);
 void radio_phy_get_last_rssi_snr(int16_t *rssi, int8_t *snr);
+void radio_phy_get_rx_stats(radio_rx_stats_t *out);
+bool radio_phy_set_lbt(const radio_lbt_config_t *cfg);
+void radio_phy_get_lbt_stats(radio_lbt_stats_t *out);
+void radio_phy_set_boot_hint(const radio_boot_info_t *hint);
+void radio_phy_get_boot_info(radio_boot_info_t *out);
 
 #ifdef __cplusplus
 }
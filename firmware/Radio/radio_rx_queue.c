@@ -0,0 +1,76 @@
+/**
+ * SPSC ring of received frames. head/tail are free-running 8-bit counters;
+ * depth = head - tail. A signal fence keeps the slot contents ordered before
+ * the index update, which is all a single-core Cortex-M needs.
+ */
+
+#include "radio_rx_queue.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if (RADIO_RX_QUEUE_DEPTH & (RADIO_RX_QUEUE_DEPTH - 1)) != 0 || RADIO_RX_QUEUE_DEPTH > 128
+#error "RADIO_RX_QUEUE_DEPTH must be a power of two <= 128"
+#endif
+#define SLOT(i)  ((uint8_t)(i) & (RADIO_RX_QUEUE_DEPTH - 1))
+
+static radio_rx_frame_t slots[RADIO_RX_QUEUE_DEPTH];
+static volatile uint8_t head;   /* written by producer only */
+static volatile uint8_t tail;   /* written by consumer only */
+
+static volatile uint32_t stat_received;
+static volatile uint32_t stat_overflows;
+static volatile uint32_t stat_errors;
+static volatile uint8_t  stat_high_water;
+
+void radio_rx_queue_reset(void) {
+    head = 0;
+    tail = 0;
+    stat_received = 0;
+    stat_overflows = 0;
+    stat_errors = 0;
+    stat_high_water = 0;
+}
+
+radio_rx_frame_t *radio_rx_queue_claim(void) {
+    if ((uint8_t)(head - tail) >= RADIO_RX_QUEUE_DEPTH) {
+        stat_overflows++;
+        return NULL;
+    }
+    return &slots[SLOT(head)];
+}
+
+void radio_rx_queue_commit(void) {
+    atomic_signal_fence(memory_order_release);
+    head = (uint8_t)(head + 1);
+    uint8_t depth = (uint8_t)(head - tail);
+    if (depth > stat_high_water) stat_high_water = depth;
+    stat_received++;
+}
+
+void radio_rx_queue_note_error(void) {
+    stat_errors++;
+}
+
+radio_rx_frame_t *radio_rx_queue_peek(void) {
+    if (head == tail) return NULL;
+    atomic_signal_fence(memory_order_acquire);
+    return &slots[SLOT(tail)];
+}
+
+void radio_rx_queue_pop(void) {
+    if (head == tail) return;
+    atomic_signal_fence(memory_order_release);
+    tail = (uint8_t)(tail + 1);
+}
+
+void radio_rx_queue_get_stats(radio_rx_stats_t *out) {
+    if (!out) return;
+    out->received   = stat_received;
+    out->overflows  = stat_overflows;
+    out->errors     = stat_errors;
+    out->depth      = (uint8_t)(head - tail);
+    out->high_water = stat_high_water;
+    out->restart_last_us = 0;
+    out->restart_max_us = 0;
+    out->restart_avg_us = 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * Received-frame ring (HAL-free): single producer (radio IRQ), single consumer
+ * (main loop). Each slot holds one LoRa frame plus RSSI/SNR and RX timestamp.
+ * Lock-free: the producer only moves head, the consumer only moves tail.
+ */
+
+#ifndef RADIO_RX_QUEUE_H
+#define RADIO_RX_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Slot count, power of two. One slot is ~264 bytes of RAM. */
+#ifndef RADIO_RX_QUEUE_DEPTH
+#define RADIO_RX_QUEUE_DEPTH  4
+#endif
+#define RADIO_RX_FRAME_MAX    256
+
+typedef struct {
+    uint16_t len;
+    int16_t  rssi;      /* dBm */
+    int8_t   snr;       /* dB */
+    uint32_t rx_ms;     /* HAL tick at RxDone */
+    uint8_t  data[RADIO_RX_FRAME_MAX];
+} radio_rx_frame_t;
+
+typedef struct {
+    uint32_t received;      /* frames committed to the ring */
+    uint32_t overflows;     /* frames dropped because the ring was full */
+    uint32_t errors;        /* frames dropped by the driver (bad length, SPI error) */
+    uint8_t  depth;         /* frames currently queued */
+    uint8_t  high_water;    /* max depth seen */
+    /* RxDone IRQ entry -> SetRx re-issued (µs), filled by the driver; 0 if not measured */
+    uint32_t restart_last_us;
+    uint32_t restart_max_us;
+    uint32_t restart_avg_us;
+} radio_rx_stats_t;
+
+void radio_rx_queue_reset(void);
+
+/* Producer (IRQ): get a free slot to fill, or NULL if full (counts an overflow). */
+radio_rx_frame_t *radio_rx_queue_claim(void);
+/* Producer: publish the slot returned by claim. */
+void radio_rx_queue_commit(void);
+/* Producer: count a frame the driver could not read. */
+void radio_rx_queue_note_error(void);
+
+/* Consumer (main loop): oldest frame or NULL. The slot belongs to the consumer
+ * (readable and writable in place) until pop. */
+radio_rx_frame_t *radio_rx_queue_peek(void);
+void radio_rx_queue_pop(void);
+
+void radio_rx_queue_get_stats(radio_rx_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RADIO_RX_QUEUE_H */
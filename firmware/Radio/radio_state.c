@@ -0,0 +1,71 @@
+/**
+ * Radio state cache and image-calibration band selection.
+ */
+
+#include "radio_state.h"
+#include <stddef.h>
+
+typedef struct { uint16_t lo_mhz, hi_mhz; uint8_t f1, f2; } image_band_t;
+
+/* SX126x DS, Table 9-2 */
+static const image_band_t image_bands[] = {
+    { 430, 440, 0x6B, 0x6F },
+    { 470, 510, 0x75, 0x81 },
+    { 779, 787, 0xC1, 0xC5 },
+    { 863, 870, 0xD7, 0xDB },
+    { 902, 928, 0xE1, 0xE9 },
+};
+
+void radio_state_invalidate(radio_state_t *st) {
+    if (!st) return;
+    st->valid = false;
+    st->freq_hz = 0;
+    st->image_cal = 0;
+    st->sf = 0;
+    st->bw_param = 0xFF;
+    st->cr_param = 0;
+    st->ldro = 0xFF;
+    st->cad_sf = 0;
+    st->pkt_len = -1;
+}
+
+uint16_t radio_image_cal_for(uint32_t freq_hz) {
+    uint32_t mhz = freq_hz / 1000000u;
+    for (size_t i = 0; i < sizeof(image_bands) / sizeof(image_bands[0]); i++) {
+        if (mhz >= image_bands[i].lo_mhz && mhz < image_bands[i].hi_mhz)
+            return (uint16_t)(image_bands[i].f1 << 8 | image_bands[i].f2);
+    }
+    /* Generic: freq1 = floor((f - 4 MHz) / 4 MHz), freq2 = ceil((f + 4 MHz) / 4 MHz) */
+    uint32_t f1 = mhz > 4u ? (mhz - 4u) / 4u : 0u;
+    uint32_t f2 = (mhz + 4u + 3u) / 4u;
+    if (f2 > 0xFF) f2 = 0xFF;
+    if (f1 > f2) f1 = f2;
+    return (uint16_t)(f1 << 8 | f2);
+}
+
+uint8_t radio_state_plan(const radio_state_t *st, uint32_t freq_hz, uint8_t sf,
+                         uint8_t bw_param, uint8_t cr_param, uint8_t ldro)
+{
+    uint8_t plan = 0;
+    if (!st || !st->valid)
+        return RADIO_DELTA_FREQ | RADIO_DELTA_IMAGE | RADIO_DELTA_MODULATION | RADIO_DELTA_CAD;
+    if (st->freq_hz != freq_hz) plan |= RADIO_DELTA_FREQ;
+    if (st->image_cal != radio_image_cal_for(freq_hz)) plan |= RADIO_DELTA_IMAGE;
+    if (st->sf != sf || st->bw_param != bw_param || st->cr_param != cr_param || st->ldro != ldro)
+        plan |= RADIO_DELTA_MODULATION;
+    if (st->cad_sf != sf) plan |= RADIO_DELTA_CAD;
+    return plan;
+}
+
+void radio_state_commit(radio_state_t *st, uint32_t freq_hz, uint8_t sf,
+                        uint8_t bw_param, uint8_t cr_param, uint8_t ldro)
+{
+    if (!st) return;
+    st->freq_hz = freq_hz;
+    st->image_cal = radio_image_cal_for(freq_hz);
+    st->sf = sf;
+    st->bw_param = bw_param;
+    st->cr_param = cr_param;
+    st->ldro = ldro;
+    st->cad_sf = sf;
+}
@@ -0,0 +1,55 @@
+/**
+ * Cached radio configuration (HAL-free): remembers what the radio was last
+ * programmed with so a retune issues only the commands whose inputs changed
+ * (SetRfFrequency, CalibrateImage on band change, SetModulationParams,
+ * SetCadParams, SetPacketParams). Invalidated by a radio reset.
+ */
+
+#ifndef RADIO_STATE_H
+#define RADIO_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Commands a retune needs */
+#define RADIO_DELTA_FREQ        0x01u   /* SetRfFrequency */
+#define RADIO_DELTA_IMAGE       0x02u   /* CalibrateImage (band changed) */
+#define RADIO_DELTA_MODULATION  0x04u   /* SetModulationParams */
+#define RADIO_DELTA_CAD         0x08u   /* SetCadParams (depends on SF) */
+
+typedef struct {
+    bool     valid;          /* base config (regulator, TCXO, calibration, packet type, PA, DIO) */
+    uint32_t freq_hz;
+    uint16_t image_cal;      /* CalibrateImage freq1 << 8 | freq2; 0 = not calibrated */
+    uint8_t  sf;
+    uint8_t  bw_param;
+    uint8_t  cr_param;
+    uint8_t  ldro;
+    uint8_t  cad_sf;         /* 0 = CAD params not set */
+    int16_t  pkt_len;        /* payload length in PacketParams; -1 = unknown */
+} radio_state_t;
+
+void radio_state_invalidate(radio_state_t *st);
+
+/* CalibrateImage bytes for a frequency: SX126x band table (430-440, 470-510,
+ * 779-787, 863-870, 902-928 MHz), else a ±4 MHz window around freq_hz. */
+uint16_t radio_image_cal_for(uint32_t freq_hz);
+
+/* Which commands are needed to go from the cached state to the target.
+ * bw_param / cr_param / ldro are the register encodings. */
+uint8_t radio_state_plan(const radio_state_t *st, uint32_t freq_hz, uint8_t sf,
+                         uint8_t bw_param, uint8_t cr_param, uint8_t ldro);
+
+/* Record the target as programmed (call after the planned commands succeeded). */
+void radio_state_commit(radio_state_t *st, uint32_t freq_hz, uint8_t sf,
+                        uint8_t bw_param, uint8_t cr_param, uint8_t ldro);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RADIO_STATE_H */
@@ -1,11 +1,23 @@
 /**
  * Radio implementation for STM32WLE5 via SubGHz HAL (STM32CubeWL).
  * Full LoRa init: Standby, PacketType, RFFrequency, ModulationParams,
- * PacketParams, DIO IRQ, then SetRx. TX via WriteBuffer + SetTx; RX via
- * IRQ callback flag and rx_poll read + SetRx restart.
+ * PacketParams, DIO IRQ, then SetRx. Later retunes go through radio_state and
+ * send only the commands whose inputs changed. TX is asynchronous: WriteBuffer + SetTx,
+ * then TxDone/Timeout IRQ re-arms RX (radio_tx_fsm); with listen-before-talk a
+ * CAD (SetCadParams/SetCad) precedes SetTx and CadDone drives the backoff
+ * decision in radio_lbt. RX: the RxDone IRQ reads payload + packet status into
+ * radio_rx_queue and re-issues SetRx before returning; the main loop borrows
+ * slots in place.
  */
 #include "radio_phy.h"
+#include "radio_tx_fsm.h"
+#include "radio_rx_queue.h"
+#include "radio_lbt.h"
+#include "radio_state.h"
+#include "lora_airtime.h"
 #include "serial_io.h"
+#include "event.h"
+#include "profile.h"
 #include <string.h>
 
 /* SX1262: version string (0x0137, discrete only); REG_OCP (0x08E7) R/W for SPI write-read test */
@@ -31,11 +43,11 @@ static void subghz_wait_busy(void) {
 /* SX1262: 32 MHz crystal */
 #define XTAL_FREQ_HZ  32000000u
 
-/* Meshtastic-compatible LoRa: preamble 16 symbols, sync word 0x2B (REG_LR_SYNCWORD = 0x0740) */
-#define MESHTASTIC_LORA_PREAMBLE_LEN  16
+/* Meshtastic-compatible LoRa: preamble 16 symbols (lora_airtime.h), sync word 0x2B (REG_LR_SYNCWORD = 0x0740) */
 #define REG_LR_SYNCWORD               0x0740U
 #define REG_OCP                       0x08E7U   /* SX1262 over-current protection */
 #define REG_TX_CLAMP                  0x08D8U   /* TX clamp (ST workaround for RFO_HP) */
+#define REG_RANDOM_NUMBER_GEN         0x0819U   /* 4 bytes, wideband noise while in RX */
 
 /* Default EU868 for first listen until lora_set_region_preset is called */
 #define DEFAULT_FREQ_HZ  868100000u
@@ -46,10 +58,20 @@ static void subghz_wait_busy(void) {
 static SUBGHZ_HandleTypeDef hsubghz;
 static int16_t last_rssi;
 static int8_t  last_snr;
-static uint8_t rx_buf[256];
-static uint16_t rx_len;
-static volatile bool rx_pending;  /* set in IRQ callback, consumed in rx_poll */
-static volatile bool tx_done_flag; /* set in TxCplt IRQ callback */
+/* RxDone -> SetRx latency, DWT cycles (IRQ entry stamped in SUBGHZ_Radio_IRQHandler) */
+static uint32_t irq_entry_cyc;
+static uint32_t restart_last_cyc;
+static uint32_t restart_max_cyc;
+static uint64_t restart_sum_cyc;
+static uint32_t restart_count;
+static uint32_t rng_state = 0x2545F491u;
+static radio_state_t s_radio;    /* what the radio is currently programmed with */
+static uint32_t s_freq_hz = DEFAULT_FREQ_HZ;   /* same, in API units */
+static uint8_t  s_sf = DEFAULT_SF;
+static uint32_t s_bw_hz = DEFAULT_BW_HZ;
+static uint8_t  s_cr = DEFAULT_CR;
+static radio_boot_info_t s_boot_hint;   /* from the previous boot; cleared once used */
+static uint8_t  s_osc = RADIO_OSC_UNKNOWN;
 
 static uint32_t freq_to_rf_reg(uint32_t freq_hz) {
     return (uint32_t)(((uint64_t)freq_hz << 25) / XTAL_FREQ_HZ);
@@ -77,6 +99,39 @@ static uint8_t cr_to_param(uint8_t cr) {
     return 4;
 }
 
+static uint8_t ldro_for(uint8_t sf, uint32_t bw_hz) {
+    return (sf >= 11 && bw_hz <= 125000) ? 1 : 0;   /* LowDataRateOptimize */
+}
+
+static void calibrate_image(uint16_t cal) {
+    uint8_t buf[2] = { (uint8_t)(cal >> 8), (uint8_t)cal };
+    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CALIBRATEIMAGE, buf, 2);
+}
+
+/* SetCadParams: 2 symbols, detection peak per SF (Semtech AN1200.48), CAD only.
+ * CadDone returns the radio to STDBY_RC. */
+static void set_cad_params(uint8_t sf) {
+    static const uint8_t det_peak[] = { 22, 22, 23, 24, 25, 28 };   /* SF7..SF12 */
+    uint8_t idx = (sf < 7) ? 0 : (uint8_t)(sf > 12 ? 5 : sf - 7);
+    uint8_t buf[7] = {
+        0x01,           /* CAD_ON_2_SYMB */
+        det_peak[idx],
+        10,             /* cadDetMin */
+        0x00,           /* CAD_ONLY */
+        0x00, 0x00, 0x00,
+    };
+    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_CADPARAMS, buf, 7);
+}
+
+/* GetDeviceErrors (OpError) */
+#define RADIO_ERR_XOSC_START  0x0020U
+
+static uint16_t radio_device_errors(void) {
+    uint8_t err[2] = {0, 0};
+    HAL_SUBGHZ_ExecGetCmd(&hsubghz, RADIO_GET_ERROR, err, 2);
+    return (uint16_t)((err[0] << 8) | err[1]);
+}
+
 static void radio_apply_lora_params(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz, uint8_t cr) {
     uint8_t buf[8];
 
@@ -91,46 +146,64 @@ static void radio_apply_lora_params(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz
     /*
      * TCXO auto-detect: try TCXO first, check for XOSC error, fall back to crystal.
      * LoRa-E5 modules have TCXO on DIO3; some boards use a plain crystal instead.
+     * With a boot hint the probe (and the RF reset a crystal board needs) is
+     * skipped; calibration below still reports an oscillator that did not start.
      */
+    uint8_t hinted = s_boot_hint.osc;
+    s_boot_hint.osc = RADIO_OSC_UNKNOWN;
 #if !defined(WIO_E5_NO_TCXO)
     /* Clear previous errors so we read fresh status */
     { uint8_t clr[2] = {0, 0}; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CLR_ERROR, clr, 2); }
     subghz_wait_busy();
 
-    buf[0] = 0x01; buf[1] = 0x00; buf[2] = 0x02; buf[3] = 0x80;
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_TCXOMODE, buf, 4);
-    subghz_wait_busy();
+    if (hinted != RADIO_OSC_XTAL) {
+        buf[0] = 0x01; buf[1] = 0x00; buf[2] = 0x02; buf[3] = 0x80;
+        HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_TCXOMODE, buf, 4);
+        subghz_wait_busy();
+        s_osc = RADIO_OSC_TCXO;
+    } else {
+        s_osc = RADIO_OSC_XTAL;
+    }
 
     /* Check XOSC error (bit 5) — if set, TCXO did not start → fall back to crystal */
-    {
-        uint8_t err[2] = {0, 0};
-        HAL_SUBGHZ_ExecGetCmd(&hsubghz, RADIO_GET_ERROR, err, 2);
-        uint16_t dev_err = (uint16_t)((err[0] << 8) | err[1]);
-        if (dev_err & 0x0020U) {
-            LL_RCC_RF_EnableReset();
-            for (volatile int i = 0; i < 1000; i++) { (void)i; }
-            LL_RCC_RF_DisableReset();
-            HAL_Delay(5);
-            subghz_wait_busy();
-            buf[0] = 0x00;
-            HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, buf, 1);
-            subghz_wait_busy();
-            buf[0] = 0x01;
-            HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_REGULATORMODE, buf, 1);
-            subghz_wait_busy();
-        }
+    if (hinted == RADIO_OSC_UNKNOWN && (radio_device_errors() & RADIO_ERR_XOSC_START)) {
+        LL_RCC_RF_EnableReset();
+        for (volatile int i = 0; i < 1000; i++) { (void)i; }
+        LL_RCC_RF_DisableReset();
+        HAL_Delay(5);
+        subghz_wait_busy();
+        buf[0] = 0x00;
+        HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, buf, 1);
+        subghz_wait_busy();
+        buf[0] = 0x01;
+        HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_REGULATORMODE, buf, 1);
+        subghz_wait_busy();
+        s_osc = RADIO_OSC_XTAL;
     }
+#else
+    s_osc = RADIO_OSC_XTAL;
 #endif
 
+    /* Calibrate all blocks; BUSY stays high until it is done (~3.5 ms) */
     buf[0] = 0x7F;
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CALIBRATE, buf, 1);
     subghz_wait_busy();
-    HAL_Delay(10);
 
-    /* CalibrateImage for 863–870 MHz band (critical for RX sensitivity) */
-    buf[0] = 0xD7;
-    buf[1] = 0xDB;
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CALIBRATEIMAGE, buf, 2);
+#if !defined(WIO_E5_NO_TCXO)
+    /* Stale hint (board or wiring changed): probe from scratch */
+    if (hinted != RADIO_OSC_UNKNOWN && (radio_device_errors() & RADIO_ERR_XOSC_START)) {
+        s_boot_hint.image_cal = 0;
+        s_osc = RADIO_OSC_UNKNOWN;
+        radio_apply_lora_params(freq_hz, sf, bw_hz, cr);
+        return;
+    }
+#endif
+
+    /* CalibrateImage (critical for RX sensitivity): the band the last boot
+     * ended up in, so the region tune that follows needs no second one */
+    uint16_t image_cal = s_boot_hint.image_cal ? s_boot_hint.image_cal : radio_image_cal_for(freq_hz);
+    s_boot_hint.image_cal = 0;
+    calibrate_image(image_cal);
 
     /* Fallback to STDBY_RC on RX/TX timeout */
     buf[0] = 0x20;
@@ -152,7 +225,7 @@ static void radio_apply_lora_params(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz
     buf[0] = sf;
     buf[1] = bw_to_param(bw_hz);
     buf[2] = cr_to_param(cr);
-    buf[3] = (sf >= 11 && bw_hz <= 125000) ? 1 : 0;  /* LowDataRateOptimize */
+    buf[3] = ldro_for(sf, bw_hz);
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_MODULATIONPARAMS, buf, 4);
 
     /* RADIO_SET_PACKETPARAMS LoRa: PreambleLen(2), HeaderType(0=explicit), PayloadLen(0xFF), CrcOn(1), InvertIQ(0) */
@@ -164,6 +237,8 @@ static void radio_apply_lora_params(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz
     buf[5] = 0x00;    /* normal IQ */
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_PACKETPARAMS, buf, 6);
 
+    set_cad_params(sf);
+
     /* LoRa sync word for Meshtastic compatibility: 0x2B (second byte 0x44 recommended for SX126x) */
     uint8_t sync[] = { 0x2B, 0x44 };
     HAL_SUBGHZ_WriteRegisters(&hsubghz, REG_LR_SYNCWORD, sync, 2);
@@ -193,16 +268,26 @@ static void radio_apply_lora_params(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz
 #endif
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_TXPARAMS, buf, 2);
 
-    /* RADIO_CFG_DIOIRQ: TX_DONE(0) | RX_DONE(1) | TIMEOUT(9) on DIO1 */
-    buf[0] = 0x02;
-    buf[1] = 0x03;    /* IrqMask: 0x0203 */
-    buf[2] = 0x02;
-    buf[3] = 0x03;    /* Dio1Mask: 0x0203 */
+    /* RADIO_CFG_DIOIRQ: TX_DONE(0) | RX_DONE(1) | CAD_DONE(7) | CAD_DETECTED(8) | TIMEOUT(9) on DIO1 */
+    buf[0] = 0x03;
+    buf[1] = 0x83;    /* IrqMask: 0x0383 */
+    buf[2] = 0x03;
+    buf[3] = 0x83;    /* Dio1Mask: 0x0383 */
     buf[4] = 0x00;
     buf[5] = 0x00;
     buf[6] = 0x00;
     buf[7] = 0x00;
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CFG_DIOIRQ, buf, 8);
+
+    radio_state_commit(&s_radio, freq_hz, sf, bw_to_param(bw_hz), cr_to_param(cr),
+                       ldro_for(sf, bw_hz));
+    s_radio.image_cal = image_cal;
+    s_freq_hz = freq_hz;
+    s_sf = sf;
+    s_bw_hz = bw_hz;
+    s_cr = cr;
+    s_radio.pkt_len = 0xFF;
+    s_radio.valid = true;
 }
 
 /* Apply PA config and SetTxParams in STDBY — same as radio_pair before each TX */
@@ -223,6 +308,102 @@ static void apply_pa_tx_params(void) {
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_TXPARAMS, buf, 2);
 }
 
+/* ----- Async TX backend for radio_tx_fsm. Runs with SUBGHZ_Radio_IRQn masked
+ * (main loop) or inside the radio IRQ itself, so HAL SPI calls never nest. ----- */
+
+/* Only the payload length varies; skip the command if it is already programmed */
+static void set_packet_params(uint8_t payload_len) {
+    if (s_radio.pkt_len == payload_len) return;
+    uint8_t pkt[6] = {
+        (uint8_t)(MESHTASTIC_LORA_PREAMBLE_LEN >> 8),
+        (uint8_t)(MESHTASTIC_LORA_PREAMBLE_LEN),
+        0x00,       /* explicit header */
+        payload_len,
+        0x01,       /* CRC on */
+        0x00,       /* normal IQ */
+    };
+    if (HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_PACKETPARAMS, pkt, 6) == HAL_OK)
+        s_radio.pkt_len = payload_len;
+    else
+        s_radio.pkt_len = -1;
+}
+
+static bool be_start_tx(const uint8_t *data, uint16_t len) {
+    if (len > 255) return false;
+
+    uint8_t standby[] = { 0x00 };
+    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, standby, 1);
+    subghz_wait_busy();
+
+    apply_pa_tx_params();
+    subghz_wait_busy();
+
+    rf_ctrl_set_off();
+
+    { uint8_t clr[2] = { 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CLR_IRQSTATUS, clr, 2); }
+
+    set_packet_params((uint8_t)len);
+
+    if (HAL_SUBGHZ_WriteBuffer(&hsubghz, 0, (uint8_t *)data, len) != HAL_OK)
+        return false;
+    subghz_wait_busy();
+
+    rf_ctrl_set_tx();
+    subghz_wait_busy();
+
+    /* Radio-side timeout 0x02EE00 * 15.625 us = 3 s; radio_tx_fsm adds a software guard */
+    uint8_t tx_to[3] = { 0x02, 0xEE, 0x00 };
+    return HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_TX, tx_to, 3) == HAL_OK;
+}
+
+/* CAD is a receive operation: RF switch to RX, radio returns to STDBY_RC on CadDone */
+static bool be_start_cad(void) {
+    uint8_t standby[] = { 0x00 };
+    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, standby, 1);
+    subghz_wait_busy();
+    { uint8_t clr[2] = { 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CLR_IRQSTATUS, clr, 2); }
+    rf_ctrl_set_rx();
+    return HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_CAD, NULL, 0) == HAL_OK;
+}
+
+static void be_restart_rx(void) {
+    uint8_t standby[] = { 0x00 };
+    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, standby, 1);
+    subghz_wait_busy();
+    rf_ctrl_set_off();
+    { uint8_t clr[2] = { 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CLR_IRQSTATUS, clr, 2); }
+    set_packet_params(0xFF);
+    subghz_wait_busy();
+    rf_ctrl_set_rx();
+    { uint8_t rx_p[3] = { 0xFF, 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_p, 3); }
+}
+
+static uint32_t be_now_ms(void) {
+    return HAL_GetTick();
+}
+
+/* xorshift32 stirred with the radio's noise RNG register */
+static uint32_t be_random(void) {
+    uint8_t r[4] = { 0 };
+    HAL_SUBGHZ_ReadRegisters(&hsubghz, REG_RANDOM_NUMBER_GEN, r, 4);
+    uint32_t x = rng_state ^ ((uint32_t)r[0] << 24 | (uint32_t)r[1] << 16 |
+                              (uint32_t)r[2] << 8 | r[3]) ^ HAL_GetTick();
+    if (x == 0) x = 0x2545F491u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static const radio_tx_backend_t stm32wl_tx_backend = {
+    .start_cad  = be_start_cad,
+    .start_tx   = be_start_tx,
+    .restart_rx = be_restart_rx,
+    .now_ms     = be_now_ms,
+    .random     = be_random,
+};
+
 /* Init SUBGHZSPI before radio reset — same order as radio_pair: subghz_spi_init() then subghz_reset() */
 static void subghz_spi_init_before_reset(void) {
     __HAL_RCC_SUBGHZSPI_CLK_ENABLE();
@@ -238,8 +419,11 @@ static void subghz_spi_init_before_reset(void) {
 static bool stm32wl_radio_init(void) {
     rf_ctrl_init();
     memset(&hsubghz, 0, sizeof(hsubghz));
-    rx_pending = false;
-    rx_len = 0;
+    restart_last_cyc = restart_max_cyc = restart_sum_cyc = restart_count = 0;
+    radio_state_invalidate(&s_radio);
+    radio_rx_queue_reset();
+    radio_lbt_init();
+    radio_tx_fsm_init(&stm32wl_tx_backend);
     last_rssi = 0;
     last_snr = 0;
 
@@ -277,180 +461,180 @@ static bool stm32wl_radio_init(void) {
     rf_ctrl_set_rx();
     uint8_t rx_params[3] = { 0xFF, 0xFF, 0xFF };
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_params, 3);
-    HAL_Delay(5);
     return true;
 }
 
-static bool stm32wl_radio_set_freq(uint32_t freq_hz) {
-    uint8_t buf[4];
-    uint8_t standby[] = { 0x00 };
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, standby, 1);
-    uint32_t rf = freq_to_rf_reg(freq_hz);
-    buf[0] = (uint8_t)(rf >> 24);
-    buf[1] = (uint8_t)(rf >> 16);
-    buf[2] = (uint8_t)(rf >> 8);
-    buf[3] = (uint8_t)(rf);
-    if (HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RFFREQUENCY, buf, 4) != HAL_OK)
-        return false;
-    subghz_wait_busy();
-    rf_ctrl_set_rx();
-    uint8_t rx_params[3] = { 0xFF, 0xFF, 0xFF };
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_params, 3);
-    return true;
+static void stm32wl_radio_set_boot_hint(const radio_boot_info_t *hint) {
+    if (hint) s_boot_hint = *hint;
 }
 
-static bool stm32wl_radio_set_lora(uint8_t sf, uint32_t bw_hz, uint8_t cr) {
-    uint8_t buf[8];
-    uint8_t standby[] = { 0x00 };
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, standby, 1);
-    buf[0] = sf;
-    buf[1] = bw_to_param(bw_hz);
-    buf[2] = cr_to_param(cr);
-    buf[3] = (sf >= 11 && bw_hz <= 125000) ? 1 : 0;
-    if (HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_MODULATIONPARAMS, buf, 4) != HAL_OK)
-        return false;
-    buf[0] = (uint8_t)(MESHTASTIC_LORA_PREAMBLE_LEN >> 8);
-    buf[1] = (uint8_t)(MESHTASTIC_LORA_PREAMBLE_LEN);
-    buf[2] = 0x00;
-    buf[3] = 0xFF;
-    buf[4] = 0x01;
-    buf[5] = 0x00;
-    if (HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_PACKETPARAMS, buf, 6) != HAL_OK)
-        return false;
-    uint8_t sync[] = { 0x2B, 0x44 };
-    HAL_SUBGHZ_WriteRegisters(&hsubghz, REG_LR_SYNCWORD, sync, 2);
+static void stm32wl_radio_get_boot_info(radio_boot_info_t *out) {
+    if (!out) return;
+    out->osc = s_osc;
+    out->image_cal = s_radio.image_cal;
+}
+
+/* SetRx continuous (radio stays in RX after each RxDone) */
+static void rx_restart(void) {
     subghz_wait_busy();
     rf_ctrl_set_rx();
-    uint8_t rx_params[3] = { 0xFF, 0xFF, 0xFF };
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_params, 3);
-    return true;
+    { uint8_t rx_p[3] = { 0xFF, 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_p, 3); }
 }
 
-static bool stm32wl_radio_tx(const uint8_t *data, uint16_t len) {
-    if (!data || len > 256) return false;
+/* Delta retune: standby, only the commands radio_state says are stale, back to RX.
+ * A frequency change inside the same band costs one SetRfFrequency; image
+ * calibration (~3.5 ms) runs only when the band changes. */
+static bool stm32wl_radio_tune(uint32_t freq_hz, uint8_t sf, uint32_t bw_hz, uint8_t cr) {
+    if (radio_tx_fsm_busy()) return false;
+    uint8_t bw_p = bw_to_param(bw_hz), cr_p = cr_to_param(cr), ldro = ldro_for(sf, bw_hz);
+    uint8_t plan = radio_state_plan(&s_radio, freq_hz, sf, bw_p, cr_p, ldro);
+    if (plan == 0) return true;
 
-    /* Disable radio IRQ for the entire TX cycle to prevent HAL reentrancy:
-     * the IRQ handler calls HAL SPI functions which conflict with our calls. */
+    bool ok = true;
+    uint8_t buf[4];
     HAL_NVIC_DisableIRQ(SUBGHZ_Radio_IRQn);
-
     uint8_t standby[] = { 0x00 };
     HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, standby, 1);
     subghz_wait_busy();
 
-    apply_pa_tx_params();
-    subghz_wait_busy();
-
-    rf_ctrl_set_off();
-
-    { uint8_t clr[2] = { 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CLR_IRQSTATUS, clr, 2); }
-
-    uint8_t pkt[6] = {
-        (uint8_t)(MESHTASTIC_LORA_PREAMBLE_LEN >> 8),
-        (uint8_t)(MESHTASTIC_LORA_PREAMBLE_LEN),
-        0x00,       /* explicit header */
-        (uint8_t)len,
-        0x01,       /* CRC on */
-        0x00,       /* normal IQ */
-    };
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_PACKETPARAMS, pkt, 6);
-
-    if (HAL_SUBGHZ_WriteBuffer(&hsubghz, 0, (uint8_t *)data, len) != HAL_OK) {
-        HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
-        return false;
+    if (plan & RADIO_DELTA_IMAGE) {
+        calibrate_image(radio_image_cal_for(freq_hz));
+        subghz_wait_busy();
     }
-    subghz_wait_busy();
-
-    rf_ctrl_set_tx();
-    subghz_wait_busy();
-
-    uint8_t tx_to[3] = { 0x02, 0xEE, 0x00 };
-    if (HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_TX, tx_to, 3) != HAL_OK) {
-        rf_ctrl_set_rx();
-        HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
-        return false;
+    if (plan & RADIO_DELTA_FREQ) {
+        uint32_t rf = freq_to_rf_reg(freq_hz);
+        buf[0] = (uint8_t)(rf >> 24);
+        buf[1] = (uint8_t)(rf >> 16);
+        buf[2] = (uint8_t)(rf >> 8);
+        buf[3] = (uint8_t)(rf);
+        ok = HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RFFREQUENCY, buf, 4) == HAL_OK;
     }
-
-    /* Poll GetIrqStatus directly — safe because IRQ handler is disabled */
-    uint32_t t0 = HAL_GetTick();
-    uint16_t final_irq = 0;
-    bool tx_ok = false;
-    while ((HAL_GetTick() - t0) < 4000u) {
-        uint8_t irq[2];
-        if (HAL_SUBGHZ_ExecGetCmd(&hsubghz, RADIO_GET_IRQSTATUS, irq, 2) == HAL_OK) {
-            final_irq = (uint16_t)((irq[0] << 8) | irq[1]);
-            if (final_irq & 0x0201u) {  /* TX_DONE(bit0) or TIMEOUT(bit9) */
-                tx_ok = (final_irq & 0x01u) != 0;
-                break;
-            }
-        }
+    if (ok && (plan & RADIO_DELTA_MODULATION)) {
+        buf[0] = sf;
+        buf[1] = bw_p;
+        buf[2] = cr_p;
+        buf[3] = ldro;
+        ok = HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_MODULATIONPARAMS, buf, 4) == HAL_OK;
     }
-    /* Return to RX */
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_STANDBY, standby, 1);
-    subghz_wait_busy();
-    rf_ctrl_set_off();
-    { uint8_t clr[2] = { 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CLR_IRQSTATUS, clr, 2); }
-    pkt[3] = 0xFF;
-    HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_PACKETPARAMS, pkt, 6);
-    subghz_wait_busy();
-    rf_ctrl_set_rx();
-    { uint8_t rx_p[3] = { 0xFF, 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_p, 3); }
+    if (ok && (plan & RADIO_DELTA_CAD))
+        set_cad_params(sf);
+
+    if (ok) {
+        radio_state_commit(&s_radio, freq_hz, sf, bw_p, cr_p, ldro);
+        s_freq_hz = freq_hz;
+        s_sf = sf;
+        s_bw_hz = bw_hz;
+        s_cr = cr;
+    } else {
+        /* Base config still holds; force every tunable command next time */
+        int16_t pkt_len = s_radio.pkt_len;
+        radio_state_invalidate(&s_radio);
+        s_radio.pkt_len = pkt_len;
+        s_radio.valid = true;
+    }
+    rx_restart();
+    HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
+    return ok;
+}
 
-    /* Clear any pending NVIC IRQ accumulated during TX, then re-enable for RX */
-    NVIC_ClearPendingIRQ(SUBGHZ_Radio_IRQn);
+static bool stm32wl_radio_set_freq(uint32_t freq_hz) {
+    return stm32wl_radio_tune(freq_hz, s_sf, s_bw_hz, s_cr);
+}
+
+static bool stm32wl_radio_set_lora(uint8_t sf, uint32_t bw_hz, uint8_t cr) {
+    return stm32wl_radio_tune(s_freq_hz, sf, bw_hz, cr);
+}
+
+static bool stm32wl_radio_tx_start(const uint8_t *data, uint16_t len) {
+    if (!data || len == 0) return false;
+    HAL_NVIC_DisableIRQ(SUBGHZ_Radio_IRQn);
+    bool ok = radio_tx_fsm_start(data, len);
     HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
-    return tx_ok;
+    return ok;
 }
 
-static uint16_t stm32wl_radio_rx_poll(uint8_t *buf, uint16_t max_len) {
-    if (!buf || max_len == 0) return 0;
-    if (!rx_pending) return 0;
+static bool stm32wl_radio_tx_busy(void) {
+    return radio_tx_fsm_busy();
+}
 
-    /* Disable radio IRQ while we access HAL SPI to prevent reentrancy */
+static void stm32wl_radio_service(void) {
+    if (!radio_tx_fsm_busy()) return;
     HAL_NVIC_DisableIRQ(SUBGHZ_Radio_IRQn);
-    rx_pending = false;
+    radio_tx_fsm_poll();
+    HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
+}
 
+/* RxDone (radio IRQ context): copy payload + packet status straight into a ring slot,
+ * so a second frame can arrive before the main loop gets to the first one. */
+static void rx_read_frame(void) {
     uint8_t status[2];
     if (HAL_SUBGHZ_ExecGetCmd(&hsubghz, RADIO_GET_RXBUFFERSTATUS, status, 2) != HAL_OK) {
-        NVIC_ClearPendingIRQ(SUBGHZ_Radio_IRQn);
-        HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
-        return 0;
+        radio_rx_queue_note_error();
+        return;
     }
     uint8_t payload_len = status[0];
     uint8_t offset = status[1];
-    if (payload_len == 0 || payload_len > max_len || payload_len > sizeof(rx_buf)) {
-        subghz_wait_busy();
-        rf_ctrl_set_rx();
-        { uint8_t rx_p[3] = { 0xFF, 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_p, 3); }
-        NVIC_ClearPendingIRQ(SUBGHZ_Radio_IRQn);
-        HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
-        return 0;
+    if (payload_len == 0) {
+        radio_rx_queue_note_error();
+        return;
     }
-    if (HAL_SUBGHZ_ReadBuffer(&hsubghz, offset, rx_buf, payload_len) != HAL_OK) {
-        subghz_wait_busy();
-        rf_ctrl_set_rx();
-        { uint8_t rx_p[3] = { 0xFF, 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_p, 3); }
-        NVIC_ClearPendingIRQ(SUBGHZ_Radio_IRQn);
-        HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
-        return 0;
+    radio_rx_frame_t *f = radio_rx_queue_claim();
+    if (!f) return;  /* ring full: counted as overflow */
+    if (HAL_SUBGHZ_ReadBuffer(&hsubghz, offset, f->data, payload_len) != HAL_OK) {
+        radio_rx_queue_note_error();
+        return;
     }
-    memcpy(buf, rx_buf, payload_len);
-    rx_len = payload_len;
-
-    { uint8_t clr[2] = { 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_CLR_IRQSTATUS, clr, 2); }
-
+    f->len = payload_len;
+    f->rx_ms = HAL_GetTick();
+    f->rssi = 0;
+    f->snr = 0;
     uint8_t pkt_status[3];
     if (HAL_SUBGHZ_ExecGetCmd(&hsubghz, RADIO_GET_PACKETSTATUS, pkt_status, 3) == HAL_OK) {
-        last_rssi = (int16_t)(-(int8_t)pkt_status[1] / 2);
-        last_snr = (int8_t)pkt_status[2] / 4;
+        f->rssi = (int16_t)(-(int16_t)pkt_status[0] / 2);   /* RssiPkt */
+        f->snr = (int8_t)((int8_t)pkt_status[1] / 4);       /* SnrPkt, 0.25 dB steps */
     }
+    radio_rx_queue_commit();
+}
 
-    subghz_wait_busy();
-    rf_ctrl_set_rx();
-    { uint8_t rx_p[3] = { 0xFF, 0xFF, 0xFF }; HAL_SUBGHZ_ExecSetCmd(&hsubghz, RADIO_SET_RX, rx_p, 3); }
+static radio_rx_frame_t *stm32wl_radio_rx_borrow(void) {
+    radio_rx_frame_t *f = radio_rx_queue_peek();
+    if (f) {
+        last_rssi = f->rssi;
+        last_snr = f->snr;
+    }
+    return f;
+}
 
-    NVIC_ClearPendingIRQ(SUBGHZ_Radio_IRQn);
+static void stm32wl_radio_rx_release(void) {
+    radio_rx_queue_pop();
+}
+
+static void stm32wl_radio_get_rx_stats(radio_rx_stats_t *out) {
+    radio_rx_queue_get_stats(out);
+    if (!out) return;
+    uint32_t cyc_per_us = SystemCoreClock / 1000000u;
+    if (cyc_per_us == 0) cyc_per_us = 1;
+    HAL_NVIC_DisableIRQ(SUBGHZ_Radio_IRQn);
+    uint32_t last = restart_last_cyc, max = restart_max_cyc;
+    uint64_t sum = restart_sum_cyc;
+    uint32_t n = restart_count;
     HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
-    return payload_len;
+    out->restart_last_us = last / cyc_per_us;
+    out->restart_max_us = max / cyc_per_us;
+    out->restart_avg_us = n ? (uint32_t)(sum / n) / cyc_per_us : 0;
+}
+
+/* LBT config is read from the CadDone IRQ: update with the radio IRQ masked */
+static bool stm32wl_radio_set_lbt(const radio_lbt_config_t *cfg) {
+    if (!cfg) return false;
+    HAL_NVIC_DisableIRQ(SUBGHZ_Radio_IRQn);
+    radio_lbt_configure(cfg);
+    HAL_NVIC_EnableIRQ(SUBGHZ_Radio_IRQn);
+    return true;
+}
+
+static void stm32wl_radio_get_lbt_stats(radio_lbt_stats_t *out) {
+    radio_lbt_get_stats(out);
 }
 
 static void stm32wl_radio_get_rssi_snr(int16_t *rssi, int8_t *snr) {
@@ -462,9 +646,18 @@ static const radio_phy_ops_t stm32wl_ops = {
     .init = stm32wl_radio_init,
     .set_freq = stm32wl_radio_set_freq,
     .set_lora = stm32wl_radio_set_lora,
-    .tx = stm32wl_radio_tx,
-    .rx_poll = stm32wl_radio_rx_poll,
+    .tune = stm32wl_radio_tune,
+    .tx_start = stm32wl_radio_tx_start,
+    .tx_busy = stm32wl_radio_tx_busy,
+    .service = stm32wl_radio_service,
+    .rx_borrow = stm32wl_radio_rx_borrow,
+    .rx_release = stm32wl_radio_rx_release,
     .get_last_rssi_snr = stm32wl_radio_get_rssi_snr,
+    .get_rx_stats = stm32wl_radio_get_rx_stats,
+    .set_lbt = stm32wl_radio_set_lbt,
+    .get_lbt_stats = stm32wl_radio_get_lbt_stats,
+    .set_boot_hint = stm32wl_radio_set_boot_hint,
+    .get_boot_info = stm32wl_radio_get_boot_info,
 };
 
 void radio_stm32wl_register(void) {
@@ -486,24 +679,46 @@ void HAL_SUBGHZ_MspDeInit(SUBGHZ_HandleTypeDef *hsubghz_handle) {
     __HAL_RCC_SUBGHZSPI_CLK_DISABLE();
 }
 
-/* Called from HAL when RX complete IRQ is detected */
+/* Called from HAL when RX complete IRQ is detected: frame goes to the RX ring now */
 void HAL_SUBGHZ_RxCpltCallback(SUBGHZ_HandleTypeDef *h) {
     (void)h;
-    rx_pending = true;
+    rx_read_frame();
+    /* Back to RX before leaving the IRQ: the main loop never gates the receiver.
+     * In CAD/TX the FSM owns the radio and re-arms RX itself. */
+    radio_tx_state_t st = radio_tx_fsm_state();
+    if (st == RADIO_TX_STATE_IDLE || st == RADIO_TX_STATE_BACKOFF) {
+        PROF_BEGIN(t);
+        rx_restart();
+        PROF_END(PROF_RX_RESTART, t);
+        uint32_t cyc = DWT->CYCCNT - irq_entry_cyc;
+        restart_last_cyc = cyc;
+        if (cyc > restart_max_cyc) restart_max_cyc = cyc;
+        restart_sum_cyc += cyc;
+        restart_count++;
+    }
+}
+
+/* CAD result (LBT): the FSM transmits, backs off in RX, or gives up */
+void HAL_SUBGHZ_CADStatusCallback(SUBGHZ_HandleTypeDef *h, HAL_SUBGHZ_CadStatusTypeDef cadstatusflag) {
+    (void)h;
+    radio_tx_fsm_on_cad_done(cadstatusflag == HAL_SUBGHZ_CAD_DETECTED);
 }
 
+/* TX events: the FSM re-arms RX right here and notifies the application */
 void HAL_SUBGHZ_TxCpltCallback(SUBGHZ_HandleTypeDef *h) {
     (void)h;
-    tx_done_flag = true;
+    radio_tx_fsm_on_tx_done();
 }
 
 void HAL_SUBGHZ_RxTxTimeoutCallback(SUBGHZ_HandleTypeDef *h) {
     (void)h;
-    /* tx_done_flag stays false — polling loop will report TIMEOUT */
+    radio_tx_fsm_on_timeout();  /* ignored unless a TX is in flight (RX is continuous) */
 }
 
 void SUBGHZ_Radio_IRQHandler(void) {
+    irq_entry_cyc = DWT->CYCCNT;
     HAL_SUBGHZ_IRQHandler(&hsubghz);
+    event_post(EVENT_RADIO);
 }
 
 #else
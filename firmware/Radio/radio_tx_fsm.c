@@ -0,0 +1,115 @@
+/**
+ * Asynchronous TX state machine:
+ *   IDLE -> [CAD -> (BACKOFF -> CAD)*] -> TX -> (TxDone | Timeout | guard) -> IDLE.
+ * Every exit to IDLE re-arms RX and reports the result via radio_phy_notify_tx_done().
+ */
+
+#include "radio_tx_fsm.h"
+#include <stddef.h>
+#include <string.h>
+
+#define TX_FRAME_MAX  255u
+
+static const radio_tx_backend_t *s_be;
+static volatile radio_tx_state_t s_state;
+static uint32_t s_state_ms;       /* entry time of CAD / TX, or backoff deadline */
+static uint8_t  s_frame[TX_FRAME_MAX];
+static uint16_t s_len;
+
+void radio_tx_fsm_init(const radio_tx_backend_t *backend) {
+    s_be = backend;
+    s_state = RADIO_TX_STATE_IDLE;
+    s_state_ms = 0;
+    s_len = 0;
+}
+
+static void tx_finish(radio_tx_result_t result) {
+    if (s_state == RADIO_TX_STATE_IDLE) return;
+    s_state = RADIO_TX_STATE_IDLE;
+    s_be->restart_rx();
+    radio_phy_notify_tx_done(result);
+}
+
+/* Enter TX before SetTx so a fast TxDone IRQ finds the right state */
+static bool enter_tx(void) {
+    s_state_ms = s_be->now_ms();
+    s_state = RADIO_TX_STATE_TX;
+    return s_be->start_tx(s_frame, s_len);
+}
+
+static bool enter_cad(void) {
+    s_state_ms = s_be->now_ms();
+    s_state = RADIO_TX_STATE_CAD;
+    return s_be->start_cad();
+}
+
+bool radio_tx_fsm_start(const uint8_t *data, uint16_t len) {
+    if (!s_be || !data || len == 0 || len > TX_FRAME_MAX) return false;
+    if (s_state != RADIO_TX_STATE_IDLE) return false;
+    memcpy(s_frame, data, len);
+    s_len = len;
+
+    bool ok;
+    if (radio_lbt_enabled() && s_be->start_cad) {
+        radio_lbt_begin();
+        ok = enter_cad();
+    } else {
+        ok = enter_tx();
+    }
+    if (!ok) {
+        s_state = RADIO_TX_STATE_IDLE;
+        s_be->restart_rx();
+    }
+    return ok;
+}
+
+void radio_tx_fsm_on_cad_done(bool detected) {
+    if (s_state != RADIO_TX_STATE_CAD) return;
+    uint32_t backoff_ms = 0;
+    uint32_t rnd = s_be->random ? s_be->random() : s_be->now_ms();
+    switch (radio_lbt_on_cad(detected, rnd, &backoff_ms)) {
+    case RADIO_LBT_CLEAR:
+        if (!enter_tx()) tx_finish(RADIO_TX_TIMEOUT);
+        break;
+    case RADIO_LBT_BACKOFF:
+        /* Listen while waiting; a frame arriving now still lands in the RX ring */
+        s_state_ms = s_be->now_ms() + backoff_ms;
+        s_state = RADIO_TX_STATE_BACKOFF;
+        s_be->restart_rx();
+        break;
+    case RADIO_LBT_GIVE_UP:
+    default:
+        tx_finish(RADIO_TX_CHANNEL_BUSY);
+        break;
+    }
+}
+
+void radio_tx_fsm_on_tx_done(void) {
+    if (s_state != RADIO_TX_STATE_TX) return;
+    tx_finish(RADIO_TX_OK);
+}
+
+void radio_tx_fsm_on_timeout(void) {
+    if (s_state != RADIO_TX_STATE_TX) return;
+    tx_finish(RADIO_TX_TIMEOUT);
+}
+
+void radio_tx_fsm_poll(void) {
+    if (!s_be || s_state == RADIO_TX_STATE_IDLE) return;
+    uint32_t now = s_be->now_ms();
+    if (s_state == RADIO_TX_STATE_BACKOFF) {
+        if ((int32_t)(now - s_state_ms) >= 0 && !enter_cad())
+            tx_finish(RADIO_TX_TIMEOUT);
+        return;
+    }
+    if ((uint32_t)(now - s_state_ms) >= RADIO_TX_GUARD_MS)
+        tx_finish(RADIO_TX_TIMEOUT);
+}
+
+bool radio_tx_fsm_busy(void) {
+    return s_state != RADIO_TX_STATE_IDLE;
+}
+
+radio_tx_state_t radio_tx_fsm_state(void) {
+    return s_state;
+}
@@ -0,0 +1,65 @@
+/**
+ * Asynchronous TX state machine (HAL-free).
+ * The driver supplies a backend (start CAD, start TX, restart RX, clock, random);
+ * completion comes from the radio IRQ (CadDone / TxDone / Timeout) or from the
+ * timers in radio_tx_fsm_poll(). With listen-before-talk enabled (radio_lbt)
+ * every frame goes CAD -> [BACKOFF -> CAD]* -> TX. A fake backend is enough to
+ * run it on a host.
+ */
+
+#ifndef RADIO_TX_FSM_H
+#define RADIO_TX_FSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "radio_phy.h"
+#include "radio_lbt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Software guard on top of the radio's own TX timeout (ms) */
+#ifndef RADIO_TX_GUARD_MS
+#define RADIO_TX_GUARD_MS  4000u
+#endif
+
+typedef enum {
+    RADIO_TX_STATE_IDLE,
+    RADIO_TX_STATE_CAD,      /* SetCad issued, waiting for CadDone */
+    RADIO_TX_STATE_BACKOFF,  /* channel busy: back in RX until the backoff expires */
+    RADIO_TX_STATE_TX,       /* SetTx issued, waiting for TxDone / Timeout */
+} radio_tx_state_t;
+
+typedef struct {
+    bool     (*start_cad)(void);                             /* SetCad (CAD only) */
+    bool     (*start_tx)(const uint8_t *data, uint16_t len); /* write buffer + SetTx */
+    void     (*restart_rx)(void);                            /* back to continuous RX */
+    uint32_t (*now_ms)(void);
+    uint32_t (*random)(void);                                /* backoff slot draw */
+} radio_tx_backend_t;
+
+void radio_tx_fsm_init(const radio_tx_backend_t *backend);
+
+/* Start TX (frame is copied; the caller's buffer is free on return). Returns false
+ * if busy or the backend refused the frame (RX is re-armed). */
+bool radio_tx_fsm_start(const uint8_t *data, uint16_t len);
+
+/* Radio IRQ events (call from HAL_SUBGHZ_CADStatusCallback / TxCpltCallback /
+ * RxTxTimeoutCallback). */
+void radio_tx_fsm_on_cad_done(bool detected);
+void radio_tx_fsm_on_tx_done(void);
+void radio_tx_fsm_on_timeout(void);
+
+/* Main-loop housekeeping: ends a backoff (next CAD) and fires the guard timeout
+ * if an IRQ never came. */
+void radio_tx_fsm_poll(void);
+
+bool radio_tx_fsm_busy(void);
+radio_tx_state_t radio_tx_fsm_state(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RADIO_TX_FSM_H */
@@ -0,0 +1,420 @@
+/**
+ * Serial client API: ToRadio decoder and streaming FromRadio encoder.
+ * Each FromRadio is produced by the same encoder twice: a size pass (the
+ * frame header carries the length), then a pass that writes into the TX
+ * ring right behind the header. Submessages get their length prefix the
+ * same way. Nothing is staged in a separate buffer.
+ */
+
+#include "serial_api.h"
+#include "serial_framing.h"
+#include "../Core/serial_io.h"
+#include "../Mesh/channel_table.h"
+#include <string.h>
+
+/* Field numbers from meshtastic mesh.proto / channel.proto */
+#define FR_ID                  1
+#define FR_PACKET              2
+#define FR_MY_INFO             3
+#define FR_NODE_INFO           4
+#define FR_CONFIG_COMPLETE_ID  7
+#define FR_CHANNEL             10
+
+#define TR_PACKET              1
+#define TR_WANT_CONFIG_ID      3
+#define TR_DISCONNECT          4
+
+#define MP_FROM                1
+#define MP_TO                  2
+#define MP_CHANNEL             3
+#define MP_DECODED             4
+#define MP_ID                  6
+#define MP_RX_SNR              8
+#define MP_HOP_LIMIT           9
+#define MP_WANT_ACK            10
+#define MP_RX_RSSI             12
+#define MP_HOP_START           15
+
+#define CHANNEL_ROLE_PRIMARY   1
+#define CHANNEL_ROLE_SECONDARY 2
+
+/* Protobuf wire types */
+#define WT_VARINT   0
+#define WT_FIXED64  1
+#define WT_LEN      2
+#define WT_FIXED32  5
+
+static const device_config_t *s_cfg;
+static serial_api_send_cb_t s_send_cb;
+static bool s_active;
+static uint32_t s_from_radio_id;
+static serial_api_stats_t s_stats;
+
+/* --- Writer --- */
+
+typedef struct {
+    uint16_t len;
+    bool     write;     /* false = size pass */
+} pbw_t;
+
+typedef void (*pbw_fn_t)(pbw_t *w, const void *arg);
+
+static void pbw_raw(pbw_t *w, const void *p, uint16_t n) {
+    if (w->write) serial_tx_put((const uint8_t *)p, n);
+    w->len = (uint16_t)(w->len + n);
+}
+
+static void pbw_varint(pbw_t *w, uint64_t v) {
+    uint8_t b[10];
+    uint8_t n = 0;
+    while (v >= 0x80) {
+        b[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    b[n++] = (uint8_t)v;
+    pbw_raw(w, b, n);
+}
+
+static void pbw_tag(pbw_t *w, uint8_t field, uint8_t wire) {
+    pbw_varint(w, (uint32_t)field << 3 | wire);
+}
+
+static void pbw_le32(pbw_t *w, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    pbw_raw(w, b, 4);
+}
+
+/* Scalars: zero is the proto3 default and is not sent */
+static void pbw_uint(pbw_t *w, uint8_t field, uint32_t v) {
+    if (!v) return;
+    pbw_tag(w, field, WT_VARINT);
+    pbw_varint(w, v);
+}
+
+/* int32: negative values are sign-extended to 10 bytes, as protobuf does */
+static void pbw_int(pbw_t *w, uint8_t field, int32_t v) {
+    if (!v) return;
+    pbw_tag(w, field, WT_VARINT);
+    pbw_varint(w, (uint64_t)(int64_t)v);
+}
+
+static void pbw_fixed32(pbw_t *w, uint8_t field, uint32_t v) {
+    if (!v) return;
+    pbw_tag(w, field, WT_FIXED32);
+    pbw_le32(w, v);
+}
+
+static void pbw_float(pbw_t *w, uint8_t field, float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    pbw_fixed32(w, field, u);
+}
+
+static void pbw_bytes(pbw_t *w, uint8_t field, const void *p, uint16_t n) {
+    if (!n) return;
+    pbw_tag(w, field, WT_LEN);
+    pbw_varint(w, n);
+    pbw_raw(w, p, n);
+}
+
+static void pbw_str(pbw_t *w, uint8_t field, const char *s, uint16_t max) {
+    uint16_t n = 0;
+    while (n < max && s[n]) n++;
+    pbw_bytes(w, field, s, n);
+}
+
+/* Submessage: size pass for the length prefix, then the content. Always
+ * sent, even empty (presence matters for message fields and oneofs). */
+static void pbw_msg(pbw_t *w, uint8_t field, pbw_fn_t fn, const void *arg) {
+    pbw_t size = { 0, false };
+    fn(&size, arg);
+    pbw_tag(w, field, WT_LEN);
+    pbw_varint(w, size.len);
+    fn(w, arg);
+}
+
+/* One FromRadio frame: id + the payload variant written by fn. Dropped
+ * whole if the TX ring cannot take it. */
+static void send_from_radio(pbw_fn_t fn, const void *arg) {
+    uint32_t id = ++s_from_radio_id;
+    pbw_t size = { 0, false };
+    pbw_uint(&size, FR_ID, id);
+    fn(&size, arg);
+    if (!serial_packet_begin(size.len)) {
+        s_stats.tx_dropped++;
+        return;
+    }
+    pbw_t w = { 0, true };
+    pbw_uint(&w, FR_ID, id);
+    fn(&w, arg);
+    serial_packet_end();
+    s_stats.frames_out++;
+}
+
+/* --- FromRadio content --- */
+
+static void enc_data(pbw_t *w, const void *arg) {
+    const mesh_data_t *d = (const mesh_data_t *)arg;
+    pbw_uint(w, 1, d->portnum);
+    pbw_bytes(w, 2, d->payload, d->payload_len);
+    pbw_uint(w, 3, d->want_response);
+    pbw_fixed32(w, 4, d->dest);
+    pbw_fixed32(w, 5, d->source);
+    pbw_fixed32(w, 6, d->request_id);
+    pbw_fixed32(w, 7, d->reply_id);
+    pbw_fixed32(w, 8, d->emoji);
+    if (d->has_bitfield) {
+        pbw_tag(w, 9, WT_VARINT);
+        pbw_varint(w, d->bitfield);
+    }
+}
+
+static void enc_mesh_packet(pbw_t *w, const void *arg) {
+    const serial_api_packet_t *p = (const serial_api_packet_t *)arg;
+    pbw_fixed32(w, MP_FROM, p->from);
+    pbw_fixed32(w, MP_TO, p->to);
+    pbw_uint(w, MP_CHANNEL, p->channel);
+    pbw_msg(w, MP_DECODED, enc_data, &p->data);
+    pbw_fixed32(w, MP_ID, p->id);
+    pbw_float(w, MP_RX_SNR, (float)p->rx_snr);
+    pbw_uint(w, MP_HOP_LIMIT, p->hop_limit);
+    pbw_uint(w, MP_WANT_ACK, p->want_ack);
+    pbw_int(w, MP_RX_RSSI, p->rx_rssi);
+    pbw_uint(w, MP_HOP_START, p->hop_start);
+}
+
+static void fr_packet(pbw_t *w, const void *arg) {
+    pbw_msg(w, FR_PACKET, enc_mesh_packet, arg);
+}
+
+/* MyNodeInfo { my_node_num = 1 } */
+static void enc_my_info(pbw_t *w, const void *arg) {
+    (void)arg;
+    pbw_uint(w, 1, s_cfg->node_id);
+}
+
+static void fr_my_info(pbw_t *w, const void *arg) {
+    pbw_msg(w, FR_MY_INFO, enc_my_info, arg);
+}
+
+/* User { id = 1 ("!xxxxxxxx"), long_name = 2, short_name = 3 } */
+static void enc_user(pbw_t *w, const void *arg) {
+    static const char hex[] = "0123456789abcdef";
+    (void)arg;
+    char id[9];
+    id[0] = '!';
+    for (uint8_t i = 0; i < 8; i++)
+        id[1 + i] = hex[(s_cfg->node_id >> (28 - 4 * i)) & 0xFu];
+    pbw_bytes(w, 1, id, sizeof(id));
+    pbw_str(w, 2, s_cfg->long_name, sizeof(s_cfg->long_name));
+    pbw_str(w, 3, s_cfg->short_name, sizeof(s_cfg->short_name));
+}
+
+/* NodeInfo { num = 1, user = 2 } */
+static void enc_node_info(pbw_t *w, const void *arg) {
+    pbw_uint(w, 1, s_cfg->node_id);
+    pbw_msg(w, 2, enc_user, arg);
+}
+
+static void fr_node_info(pbw_t *w, const void *arg) {
+    pbw_msg(w, FR_NODE_INFO, enc_node_info, arg);
+}
+
+typedef struct {
+    uint8_t index;
+    const config_channel_t *ch;
+} channel_arg_t;
+
+/* ChannelSettings { psk = 2, name = 3 } */
+static void enc_channel_settings(pbw_t *w, const void *arg) {
+    const config_channel_t *c = (const config_channel_t *)arg;
+    pbw_bytes(w, 2, c->psk, c->psk_len);
+    pbw_str(w, 3, c->name, sizeof(c->name));
+}
+
+/* Channel { index = 1, settings = 2, role = 3 } */
+static void enc_channel(pbw_t *w, const void *arg) {
+    const channel_arg_t *a = (const channel_arg_t *)arg;
+    pbw_uint(w, 1, a->index);
+    pbw_msg(w, 2, enc_channel_settings, a->ch);
+    pbw_uint(w, 3, a->index == 0 ? CHANNEL_ROLE_PRIMARY : CHANNEL_ROLE_SECONDARY);
+}
+
+static void fr_channel(pbw_t *w, const void *arg) {
+    pbw_msg(w, FR_CHANNEL, enc_channel, arg);
+}
+
+/* oneof member: sent even when 0 */
+static void fr_config_complete(pbw_t *w, const void *arg) {
+    pbw_tag(w, FR_CONFIG_COMPLETE_ID, WT_VARINT);
+    pbw_varint(w, *(const uint32_t *)arg);
+}
+
+static void send_config(uint32_t config_id) {
+    send_from_radio(fr_my_info, NULL);
+    send_from_radio(fr_node_info, NULL);
+    for (uint8_t i = 0; i < channel_table_count(); i++) {
+        channel_arg_t a = { i, channel_table_get(i) };
+        send_from_radio(fr_channel, &a);
+    }
+    send_from_radio(fr_config_complete, &config_id);
+}
+
+/* --- Reader --- */
+
+typedef struct {
+    const uint8_t *buf;
+    uint16_t len;
+    uint16_t pos;
+} pbr_t;
+
+typedef struct {
+    uint32_t field;
+    uint8_t  wire;
+    uint32_t v;             /* varint / fixed32 value, or length */
+    const uint8_t *p;       /* length-delimited content */
+} pbr_field_t;
+
+/* Up to 10 bytes; bits above 32 are dropped */
+static bool pbr_varint(pbr_t *r, uint32_t *v) {
+    uint32_t val = 0;
+    for (unsigned i = 0; i < 10; i++) {
+        if (r->pos >= r->len) return false;
+        uint8_t b = r->buf[r->pos++];
+        if (i < 5) val |= (uint32_t)(b & 0x7F) << (7 * i);
+        if (!(b & 0x80)) {
+            *v = val;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* 1 = field read, 0 = end of message, -1 = malformed */
+static int pbr_next(pbr_t *r, pbr_field_t *f) {
+    if (r->pos >= r->len) return 0;
+    uint32_t tag;
+    if (!pbr_varint(r, &tag)) return -1;
+    f->field = tag >> 3;
+    f->wire = (uint8_t)(tag & 7);
+    f->p = NULL;
+    if (f->field == 0) return -1;
+    switch (f->wire) {
+    case WT_VARINT:
+        return pbr_varint(r, &f->v) ? 1 : -1;
+    case WT_LEN:
+        if (!pbr_varint(r, &f->v) || f->v > (uint32_t)(r->len - r->pos)) return -1;
+        f->p = r->buf + r->pos;
+        r->pos = (uint16_t)(r->pos + f->v);
+        return 1;
+    case WT_FIXED32:
+        if (r->len - r->pos < 4) return -1;
+        f->v = (uint32_t)r->buf[r->pos] | ((uint32_t)r->buf[r->pos + 1] << 8) |
+               ((uint32_t)r->buf[r->pos + 2] << 16) | ((uint32_t)r->buf[r->pos + 3] << 24);
+        r->pos = (uint16_t)(r->pos + 4);
+        return 1;
+    case WT_FIXED64:
+        if (r->len - r->pos < 8) return -1;
+        r->pos = (uint16_t)(r->pos + 8);
+        return 1;
+    default:
+        return -1;
+    }
+}
+
+/* MeshPacket from the client; only decoded (plaintext) payloads are accepted */
+static bool decode_mesh_packet(const uint8_t *buf, uint16_t len, serial_api_packet_t *p) {
+    memset(p, 0, sizeof(*p));
+    bool has_data = false;
+    pbr_t r = { buf, len, 0 };
+    pbr_field_t f;
+    int rc;
+    while ((rc = pbr_next(&r, &f)) > 0) {
+        switch (f.field) {
+        case MP_FROM:
+            if (f.wire != WT_FIXED32) return false;
+            p->from = f.v;
+            break;
+        case MP_TO:
+            if (f.wire != WT_FIXED32) return false;
+            p->to = f.v;
+            break;
+        case MP_ID:
+            if (f.wire != WT_FIXED32) return false;
+            p->id = f.v;
+            break;
+        case MP_CHANNEL:
+            if (f.wire != WT_VARINT) return false;
+            p->channel = (uint8_t)f.v;
+            break;
+        case MP_HOP_LIMIT:
+            if (f.wire != WT_VARINT) return false;
+            p->hop_limit = (uint8_t)f.v;
+            break;
+        case MP_WANT_ACK:
+            if (f.wire != WT_VARINT) return false;
+            p->want_ack = (f.v != 0);
+            break;
+        case MP_DECODED:
+            if (f.wire != WT_LEN || !mesh_data_decode(f.p, (uint16_t)f.v, &p->data))
+                return false;
+            has_data = true;
+            break;
+        default:
+            break;
+        }
+    }
+    return rc == 0 && has_data;
+}
+
+/* --- API --- */
+
+void serial_api_init(const device_config_t *cfg, serial_api_send_cb_t send_cb) {
+    s_cfg = cfg;
+    s_send_cb = send_cb;
+    s_active = false;
+}
+
+void serial_api_on_frame(const uint8_t *body, uint16_t len) {
+    pbr_t r = { body, len, 0 };
+    pbr_field_t f;
+    int rc;
+    bool ok = true;
+    s_stats.frames_in++;
+    while (ok && (rc = pbr_next(&r, &f)) > 0) {
+        switch (f.field) {
+        case TR_PACKET: {
+            serial_api_packet_t p;
+            if (f.wire == WT_LEN && decode_mesh_packet(f.p, (uint16_t)f.v, &p)) {
+                if (s_send_cb) s_send_cb(&p);
+            } else {
+                ok = false;
+            }
+            break;
+        }
+        case TR_WANT_CONFIG_ID:
+            if (f.wire != WT_VARINT || !s_cfg) break;
+            s_active = true;
+            send_config(f.v);
+            break;
+        case TR_DISCONNECT:
+            if (f.wire == WT_VARINT && f.v) s_active = false;
+            break;
+        default:                        /* heartbeat and others: ignored */
+            break;
+        }
+    }
+    if (!ok || rc < 0) s_stats.bad_frames++;
+}
+
+bool serial_api_active(void) {
+    return s_active;
+}
+
+void serial_api_send_packet(const serial_api_packet_t *p) {
+    if (p) send_from_radio(fr_packet, p);
+}
+
+void serial_api_get_stats(serial_api_stats_t *out) {
+    if (out) *out = s_stats;
+}
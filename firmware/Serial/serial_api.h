@@ -0,0 +1,65 @@
+/**
+ * Meshtastic client API over the framed serial link (docs/SERIAL_API.md):
+ * ToRadio in, FromRadio out, each a protobuf in one 0x94 0xC3 frame.
+ * Supported: ToRadio.packet (MeshPacket with decoded Data), want_config_id,
+ * disconnect; FromRadio.packet, my_info, node_info, channel and
+ * config_complete_id. FromRadio is encoded straight into the serial TX ring.
+ */
+
+#ifndef SERIAL_API_H
+#define SERIAL_API_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../Mesh/mesh_data.h"
+#include "../Config/config_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* MeshPacket fields the firmware uses; data.payload points into the frame
+ * it was decoded from. */
+typedef struct {
+    uint32_t    from;
+    uint32_t    to;
+    uint32_t    id;
+    uint8_t     channel;     /* channel index */
+    uint8_t     hop_limit;
+    uint8_t     hop_start;
+    bool        want_ack;
+    int16_t     rx_rssi;
+    int8_t      rx_snr;
+    mesh_data_t data;
+} serial_api_packet_t;
+
+typedef struct {
+    uint32_t frames_in;
+    uint32_t frames_out;
+    uint32_t bad_frames;     /* ToRadio that did not decode */
+    uint32_t tx_dropped;     /* FromRadio that did not fit the TX ring */
+} serial_api_stats_t;
+
+/* Client asked to send a packet on the mesh. */
+typedef void (*serial_api_send_cb_t)(const serial_api_packet_t *p);
+
+/* cfg supplies node number, names and is read at want_config time. */
+void serial_api_init(const device_config_t *cfg, serial_api_send_cb_t send_cb);
+
+/* Body of one received frame (serial_framing callback). */
+void serial_api_on_frame(const uint8_t *body, uint16_t len);
+
+/* A client has requested config and not disconnected: text output should
+ * stay off the port and received packets go out as FromRadio. */
+bool serial_api_active(void);
+
+/* FromRadio.packet for a received (decoded) mesh packet. */
+void serial_api_send_packet(const serial_api_packet_t *p);
+
+void serial_api_get_stats(serial_api_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERIAL_API_H */
@@ -1,52 +1,119 @@
 /**
  * Receive state machine: look for 0x94 0xC3, read length, then body.
- * Implement uart_tx in your project (HAL_UART_Transmit etc.).
+ * Works on spans: the hunt for START1 is a memchr and bodies are copied in
+ * one piece, or not at all when the span holds the whole frame.
+ * Sending goes through the serial TX ring (serial_io).
  */
 
 #include "serial_framing.h"
+#include "../Core/serial_io.h"
+#include <stddef.h>
 #include <string.h>
 
-enum { SYNC, LEN_MSB, LEN_LSB, BODY };
-static uint8_t  rx_state;
-static uint16_t rx_len;
-static uint16_t rx_idx;
-static uint8_t  rx_buf[SERIAL_MAX_PAYLOAD];
-static serial_packet_cb_t rx_cb;
+enum { SYNC, START2, LEN_MSB, LEN_LSB, BODY };
 
-/* External: send buffer to UART. Implement in project (HAL_UART_Transmit etc.). */
-extern void uart_tx(const uint8_t *data, uint16_t len);
+bool serial_packet_begin(uint16_t body_len) {
+    if (body_len > SERIAL_MAX_PAYLOAD || serial_tx_room() < 4u + body_len) return false;
+    uint8_t hdr[4] = { SERIAL_START1, SERIAL_START2, (uint8_t)(body_len >> 8), (uint8_t)(body_len & 0xFF) };
+    serial_tx_put(hdr, 4);
+    return true;
+}
+
+void serial_packet_end(void) {
+    serial_tx_start();
+}
 
 void serial_send_packet(const uint8_t *body, uint16_t body_len) {
-    if (!body || body_len > SERIAL_MAX_PAYLOAD) return;
-    uint8_t hdr[4] = { SERIAL_START1, SERIAL_START2, (uint8_t)(body_len >> 8), (uint8_t)(body_len & 0xFF) };
-    uart_tx(hdr, 4);
-    uart_tx(body, body_len);
+    if (!body || !serial_packet_begin(body_len)) return;
+    serial_tx_put(body, body_len);
+    serial_packet_end();
+}
+
+void serial_rx_init(serial_rx_ctx_t *ctx, serial_packet_cb_t callback) {
+    memset(ctx, 0, offsetof(serial_rx_ctx_t, buf));
+    ctx->state = SYNC;
+    ctx->cb = callback;
 }
 
-int serial_rx_byte(uint8_t byte, serial_packet_cb_t callback) {
-    rx_cb = callback;
-    switch (rx_state) {
-        case SYNC:
-            if (byte == SERIAL_START1) rx_state = LEN_MSB;
+bool serial_rx_idle(const serial_rx_ctx_t *ctx) {
+    return ctx->state == SYNC;
+}
+
+static uint16_t deliver(serial_rx_ctx_t *ctx, const uint8_t *body, uint16_t consumed) {
+    ctx->state = SYNC;
+    ctx->frames++;
+    if (ctx->cb) ctx->cb(body, ctx->len);
+    return consumed;
+}
+
+uint16_t serial_rx_feed(serial_rx_ctx_t *ctx, const uint8_t *data, uint16_t len) {
+    uint16_t i = 0;
+    while (i < len) {
+        switch (ctx->state) {
+        case SYNC: {
+            const uint8_t *p = memchr(data + i, SERIAL_START1, (size_t)(len - i));
+            uint16_t skip = p ? (uint16_t)(p - (data + i)) : (uint16_t)(len - i);
+            ctx->resync_bytes += skip;
+            i = (uint16_t)(i + skip);
+            if (!p) return i;
+            i++;
+            ctx->state = START2;
+            break;
+        }
+        case START2:
+            if (data[i] == SERIAL_START2) {
+                i++;
+                ctx->state = LEN_MSB;
+            } else if (data[i] == SERIAL_START1) {
+                i++;                    /* 0x94 0x94 0xC3: the second one starts the frame */
+                ctx->resync_bytes++;
+            } else {
+                /* Lone START1: drop it, leave this byte for the caller */
+                ctx->framing_errors++;
+                ctx->resync_bytes++;
+                ctx->state = SYNC;
+                return i;
+            }
             break;
         case LEN_MSB:
-            rx_len = (uint16_t)byte << 8;
-            rx_state = LEN_LSB;
+            ctx->len = (uint16_t)data[i++] << 8;
+            ctx->state = LEN_LSB;
             break;
         case LEN_LSB:
-            rx_len |= byte;
-            if (rx_len > SERIAL_MAX_PAYLOAD) { rx_state = SYNC; break; }
-            rx_idx = 0;
-            rx_state = BODY;
-            break;
-        case BODY:
-            rx_buf[rx_idx++] = byte;
-            if (rx_idx >= rx_len) {
-                rx_state = SYNC;
-                if (rx_cb) rx_cb(rx_buf, rx_len);
-                return 1;
+            ctx->len |= data[i++];
+            if (ctx->len > SERIAL_MAX_PAYLOAD) {
+                /* Bad length: the two length bytes may already be the next header */
+                uint8_t msb = (uint8_t)(ctx->len >> 8), lsb = (uint8_t)ctx->len;
+                ctx->framing_errors++;
+                if (msb == SERIAL_START1 && lsb == SERIAL_START2) {
+                    ctx->resync_bytes += 2;
+                    ctx->state = LEN_MSB;
+                } else if (lsb == SERIAL_START1) {
+                    ctx->resync_bytes += 3;
+                    ctx->state = START2;
+                } else {
+                    ctx->resync_bytes += 4;
+                    ctx->state = SYNC;
+                    return i;
+                }
+                break;
             }
+            ctx->idx = 0;
+            if (ctx->len == 0) return deliver(ctx, ctx->buf, i);
+            if ((uint16_t)(len - i) >= ctx->len)    /* whole body here: no copy */
+                return deliver(ctx, data + i, (uint16_t)(i + ctx->len));
+            ctx->state = BODY;
+            break;
+        case BODY: {
+            uint16_t n = (uint16_t)(ctx->len - ctx->idx);
+            if (n > (uint16_t)(len - i)) n = (uint16_t)(len - i);
+            memcpy(ctx->buf + ctx->idx, data + i, n);
+            ctx->idx = (uint16_t)(ctx->idx + n);
+            i = (uint16_t)(i + n);
+            if (ctx->idx == ctx->len) return deliver(ctx, ctx->buf, i);
             break;
+        }
+        }
     }
-    return 0;
+    return i;
 }
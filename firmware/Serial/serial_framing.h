@@ -6,6 +6,7 @@
 #define SERIAL_FRAMING_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,17 +18,48 @@ extern "C" {
 
 /**
  * Write one packet to UART: 4-byte header + body.
- * body_len must be <= SERIAL_MAX_PAYLOAD.
+ * body_len must be <= SERIAL_MAX_PAYLOAD. Dropped whole if the TX ring is full.
  */
 void serial_send_packet(const uint8_t *body, uint16_t body_len);
 
 /**
- * Non-blocking receive: feed next byte from UART.
- * On complete packet calls callback and returns 1; otherwise 0.
- * callback(buf, len) is called with packet body (without 4-byte header).
+ * Streamed packet: begin() queues the header if header + body_len fit in the
+ * TX ring (false = nothing written, skip the packet), the caller then writes
+ * exactly body_len bytes with serial_tx_put(), and end() starts sending.
  */
+bool serial_packet_begin(uint16_t body_len);
+void serial_packet_end(void);
+
 typedef void (*serial_packet_cb_t)(const uint8_t *buf, uint16_t len);
-int serial_rx_byte(uint8_t byte, serial_packet_cb_t callback);
+
+/**
+ * Receive parser, one context per port. Counters are cumulative and may be
+ * read directly.
+ */
+typedef struct {
+    uint8_t  state;
+    uint16_t len;
+    uint16_t idx;
+    serial_packet_cb_t cb;
+    uint32_t frames;
+    uint32_t framing_errors;   /* START1 without START2, or length > max */
+    uint32_t resync_bytes;     /* bytes skipped while hunting for a header */
+    uint8_t  buf[SERIAL_MAX_PAYLOAD];
+} serial_rx_ctx_t;
+
+void serial_rx_init(serial_rx_ctx_t *ctx, serial_packet_cb_t callback);
+
+/**
+ * Parse a span of received bytes. Returns how many were consumed: it stops
+ * right after a frame is delivered or abandoned, so the caller can route
+ * what follows (mixed text/frame ports); a frame-only port just calls again
+ * with the rest. callback(body, len) gets the body without the 4-byte
+ * header; it points into data when the whole body was in the span.
+ */
+uint16_t serial_rx_feed(serial_rx_ctx_t *ctx, const uint8_t *data, uint16_t len);
+
+/* True while waiting for START1 (no packet in progress). */
+bool serial_rx_idle(const serial_rx_ctx_t *ctx);
 
 #ifdef __cplusplus
 }
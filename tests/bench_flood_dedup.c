@@ -0,0 +1,137 @@
+/**
+ * Seen-table lookup cost and key loss. The table is filled to 1/2, 3/4 and
+ * all of FLOOD_DEDUP_CAPACITY, then flood_was_seen is timed on keys that are
+ * present and absent (a linear scan over the same keys alongside, at 3/4);
+ * every present key must be found and nothing evicted up to full. Then a
+ * stream of new keys, one every 5 s (about 60 live at the default max age),
+ * where each key must still be found just before it expires. Built for
+ * several capacities: bench_flood_dedup (128), _64 and _256.
+ */
+
+#include "host_test.h"
+#include "flood_router.h"
+
+#define CAP  FLOOD_DEDUP_CAPACITY
+
+typedef struct { uint32_t from; uint32_t id; } dedup_key_t;
+
+static dedup_key_t present[CAP];
+static dedup_key_t absent[CAP];
+static volatile uint32_t sink;
+
+/* Reference: the same keys in a plain array, scanned front to back */
+static bool linear_seen(uint32_t n, uint32_t from, uint32_t id) {
+    for (uint32_t i = 0; i < n; i++) {
+        if (present[i].from == from && present[i].id == id) return true;
+    }
+    return false;
+}
+
+static void report(const char *name, uint64_t ns, uint32_t n, uint32_t found) {
+    printf("  %-26s %6.1f ns/op  (%u of %u found)\n", name, (double)ns / n, found, n);
+}
+
+/* Fill with live keys, time lookups, check nothing was lost. The previous
+ * round's keys are expired first. */
+static int bench_load(uint32_t live, uint32_t reps, uint32_t *now) {
+    int fail = 0;
+    flood_dedup_stats_t st;
+    *now += FLOOD_DEDUP_MAX_AGE_MS;
+    flood_get_stats(&st, *now);
+    uint32_t evicted0 = st.evictions;
+
+    for (uint32_t i = 0; i < live; i++) {
+        present[i].from = host_rand();
+        present[i].id = host_rand();
+        absent[i].from = host_rand();
+        absent[i].id = host_rand();
+        flood_seen(present[i].from, present[i].id, *now);
+    }
+    flood_get_stats(&st, *now);
+    printf("%u/%u live, probe %u:\n", st.occupancy, CAP, st.probe_len);
+
+    const uint32_t n = reps * live;
+    uint32_t found = 0;
+    uint64_t t0 = host_now_ns();
+    for (uint32_t r = 0; r < reps; r++)
+        for (uint32_t i = 0; i < live; i++)
+            found += flood_was_seen(present[i].from, present[i].id, *now);
+    report("was_seen, present", host_now_ns() - t0, n, found);
+    if (found != n || st.occupancy != live || st.evictions != evicted0) {
+        fprintf(stderr, "%u live keys: %u lost, %u evicted\n",
+                live, live - st.occupancy, st.evictions - evicted0);
+        fail = 1;
+    }
+
+    found = 0;
+    t0 = host_now_ns();
+    for (uint32_t r = 0; r < reps; r++)
+        for (uint32_t i = 0; i < live; i++)
+            found += flood_was_seen(absent[i].from, absent[i].id, *now);
+    report("was_seen, absent", host_now_ns() - t0, n, found);
+    if (found) fail = 1;
+
+    if (live == CAP * 3 / 4) {
+        found = 0;
+        t0 = host_now_ns();
+        for (uint32_t r = 0; r < reps; r++)
+            for (uint32_t i = 0; i < live; i++)
+                found += linear_seen(live, present[i].from, present[i].id);
+        report("linear scan, present", host_now_ns() - t0, n, found);
+
+        found = 0;
+        t0 = host_now_ns();
+        for (uint32_t r = 0; r < reps; r++)
+            for (uint32_t i = 0; i < live; i++)
+                found += linear_seen(live, absent[i].from, absent[i].id);
+        report("linear scan, absent", host_now_ns() - t0, n, found);
+    }
+    return fail;
+}
+
+/* A new key every 5 s; the key from just under the max age ago must still
+ * be a duplicate */
+#define STREAM_STEP_MS  5000u
+#define STREAM_BACK     (FLOOD_DEDUP_MAX_AGE_MS / STREAM_STEP_MS - 1u)
+
+static int bench_stream(uint32_t n, uint32_t *now) {
+    static dedup_key_t recent[STREAM_BACK];
+    uint32_t found = 0, lost = 0;
+    *now += FLOOD_DEDUP_MAX_AGE_MS;
+
+    uint64_t t0 = host_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        dedup_key_t *k = &recent[i % STREAM_BACK];   /* inserted STREAM_BACK steps ago */
+        if (i >= STREAM_BACK && !flood_was_seen(k->from, k->id, *now)) lost++;
+        k->from = host_rand();
+        k->id = host_rand();
+        found += flood_check_and_insert(k->from, k->id, *now);
+        *now += STREAM_STEP_MS;
+    }
+    printf("stream, one key per %u ms:\n", STREAM_STEP_MS);
+    report("check_and_insert, new keys", host_now_ns() - t0, n, found);
+
+    flood_dedup_stats_t st;
+    flood_get_stats(&st, *now);
+    printf("  occupancy %u/%u, probe %u, expired reuse %u, evictions %u\n",
+           st.occupancy, st.capacity, st.probe_len, st.expired, st.evictions);
+    if (lost) {
+        fprintf(stderr, "stream: %u keys lost before expiry\n", lost);
+        return 1;
+    }
+    sink = found;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t reps = host_quick(argc, argv) ? 10u : 100000u;
+    uint32_t now = 1000;
+    int fail = 0;
+
+    printf("FLOOD_DEDUP_CAPACITY %u\n", CAP);
+    fail |= bench_load(CAP / 2, reps, &now);
+    fail |= bench_load(CAP * 3 / 4, reps, &now);
+    fail |= bench_load(CAP, reps / 4 + 1, &now);
+    fail |= bench_stream(reps * CAP, &now);
+    return fail;
+}
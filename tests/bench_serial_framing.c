@@ -0,0 +1,87 @@
+/**
+ * serial_rx_feed throughput: a stream of framed packets fed in DMA-sized
+ * spans and byte by byte, clean and with line noise between frames. Every
+ * run also checks that all frames came through.
+ */
+
+#include "host_test.h"
+#include "serial_framing.h"
+#include <stdlib.h>
+
+#define BODY_LEN   200u
+#define FRAMES     1000u
+
+static uint32_t delivered;
+static uint32_t bad_bodies;
+
+static void on_packet(const uint8_t *buf, uint16_t len) {
+    delivered++;
+    if (len != BODY_LEN || buf[0] != (uint8_t)(buf[1] ^ 0x5A)) bad_bodies++;
+}
+
+/* FRAMES packets, each after noise_len bytes of junk without START1 */
+static uint8_t *make_stream(uint32_t noise_len, uint32_t *out_len) {
+    uint32_t len = FRAMES * (4u + BODY_LEN + noise_len);
+    uint8_t *s = malloc(len), *p = s;
+    for (uint32_t f = 0; f < FRAMES; f++) {
+        for (uint32_t i = 0; i < noise_len; i++) {
+            uint8_t b = (uint8_t)host_rand();
+            *p++ = b == SERIAL_START1 ? 0 : b;
+        }
+        *p++ = SERIAL_START1;
+        *p++ = SERIAL_START2;
+        *p++ = (uint8_t)(BODY_LEN >> 8);
+        *p++ = (uint8_t)BODY_LEN;
+        for (uint32_t i = 0; i < BODY_LEN; i++) p[i] = (uint8_t)host_rand();
+        p[0] = (uint8_t)(p[1] ^ 0x5A);
+        p += BODY_LEN;
+    }
+    *out_len = len;
+    return s;
+}
+
+static int bench(const char *name, const uint8_t *s, uint32_t len, uint16_t span, uint32_t reps) {
+    serial_rx_ctx_t *ctx = malloc(sizeof(*ctx));
+    serial_rx_init(ctx, on_packet);
+    delivered = bad_bodies = 0;
+
+    uint64_t t0 = host_now_ns();
+    for (uint32_t r = 0; r < reps; r++) {
+        for (uint32_t off = 0; off < len; ) {
+            uint16_t n = (uint16_t)(len - off < span ? len - off : span);
+            while (n) {
+                uint16_t used = serial_rx_feed(ctx, s + off, n);
+                off += used;
+                n = (uint16_t)(n - used);
+            }
+        }
+    }
+    uint64_t ns = host_now_ns() - t0;
+    free(ctx);
+
+    printf("%-18s span %3u: %8.1f MB/s\n", name, span,
+           (double)len * reps * 1000.0 / (double)(ns ? ns : 1));
+    if (delivered != FRAMES * reps || bad_bodies) {
+        fprintf(stderr, "%s: %u of %u frames, %u bad\n", name, delivered, FRAMES * reps, bad_bodies);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t reps = host_quick(argc, argv) ? 1u : 200u;
+    int fail = 0;
+
+    uint32_t clean_len, noisy_len;
+    uint8_t *clean = make_stream(0, &clean_len);
+    uint8_t *noisy = make_stream(32, &noisy_len);
+
+    fail |= bench("clean", clean, clean_len, 256, reps);
+    fail |= bench("clean", clean, clean_len, 1, reps);
+    fail |= bench("noise between", noisy, noisy_len, 256, reps);
+    fail |= bench("noise between", noisy, noisy_len, 1, reps);
+
+    free(clean);
+    free(noisy);
+    return fail;
+}
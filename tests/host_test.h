@@ -0,0 +1,55 @@
+/**
+ * Minimal host test helpers: CHECK counts failures and reports file:line,
+ * host_now_ns() times benchmarks, host_rand() is a fixed-seed PRNG so a
+ * failing run repeats.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static int host_failures;
+
+#define CHECK(cond) do {                                                   \
+        if (!(cond)) {                                                     \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            host_failures++;                                               \
+        }                                                                  \
+    } while (0)
+
+/* main's return value: 0 if every CHECK passed */
+static inline int host_result(const char *name) {
+    if (host_failures)
+        fprintf(stderr, "%s: %d check(s) failed\n", name, host_failures);
+    else
+        printf("%s: ok\n", name);
+    return host_failures ? 1 : 0;
+}
+
+static inline uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* xorshift32 */
+static uint32_t host_rand_state = 0x12345678u;
+
+static inline uint32_t host_rand(void) {
+    uint32_t x = host_rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return host_rand_state = x;
+}
+
+/* "--quick" on the command line: benchmarks run a short smoke pass */
+static inline int host_quick(int argc, char **argv) {
+    return argc > 1 && strcmp(argv[1], "--quick") == 0;
+}
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,142 @@
+/**
+ * aes_meshtastic CTR with the Meshtastic nonce against OpenSSL output
+ * (aes-{128,256}-ctr, IV = packetId LE | 0 | fromNode LE | 0), AES-128 with
+ * the default channel key and AES-256, for full-size payloads. Built twice:
+ * test_aes uses AES-NI when the CPU has it, test_aes_soft is compiled with
+ * AES_SOFT_NO_AESNI so the portable block function is the one checked.
+ */
+
+#include "host_test.h"
+#include "aes_meshtastic.h"
+#include "aes_soft.h"
+
+static const uint8_t psk128[16] = {         /* Meshtastic default channel key */
+    0xd4, 0xf1, 0xbb, 0x3a, 0x20, 0x29, 0x07, 0x59, 0xf0, 0xbc, 0xff, 0xab, 0xcf, 0x4e, 0x69, 0x01,
+};
+
+/* plaintext (i * 7 + 3) & 0xff, packetId 0x12345678, from 0xA1B2C3D4 */
+static const uint8_t ct128_237[237] = {
+    0xf4, 0xfb, 0x50, 0x84, 0xff, 0x69, 0xeb, 0xa8, 0x15, 0x52, 0xba, 0x25, 0x8d, 0x49, 0x2d, 0x36,
+    0x00, 0xc8, 0xbe, 0xae, 0x4c, 0xfd, 0x08, 0xa8, 0x7a, 0x8f, 0xb4, 0x32, 0x4d, 0xba, 0xb6, 0x4f,
+    0xe0, 0x65, 0xd6, 0x78, 0x0c, 0xfc, 0x67, 0x85, 0x80, 0x45, 0xa3, 0x80, 0xad, 0x05, 0x85, 0x56,
+    0x3b, 0x62, 0xba, 0x36, 0x46, 0x7a, 0x49, 0xf3, 0x72, 0xb0, 0xd0, 0x6b, 0x81, 0x9d, 0x99, 0xf0,
+    0xf0, 0x67, 0x54, 0x36, 0xb3, 0x15, 0x4f, 0xf1, 0xf4, 0x76, 0x3c, 0x21, 0x27, 0xfd, 0x59, 0x0b,
+    0x80, 0x70, 0xbc, 0xd3, 0x88, 0x72, 0x87, 0xf8, 0xc8, 0x1f, 0xdb, 0xda, 0xed, 0x47, 0x4b, 0x84,
+    0xfa, 0x60, 0xa0, 0xdb, 0x93, 0x60, 0x16, 0xe1, 0x9d, 0x5f, 0xc6, 0x87, 0xc0, 0xf9, 0x34, 0xaf,
+    0xab, 0x0a, 0x98, 0xc3, 0xc3, 0x63, 0xa9, 0x1b, 0x3f, 0xfb, 0xc4, 0xbd, 0x7e, 0x2a, 0x55, 0x2f,
+    0xba, 0xc4, 0xb1, 0xa3, 0xbd, 0x6c, 0x0b, 0x15, 0xd0, 0x78, 0xff, 0x72, 0x66, 0x33, 0x35, 0x18,
+    0x64, 0xae, 0xce, 0x7a, 0x1b, 0xd7, 0x5b, 0x5d, 0x02, 0x5f, 0x5d, 0x6c, 0x8b, 0x57, 0xe5, 0x3b,
+    0x0f, 0x9e, 0xf0, 0xa1, 0x21, 0x2c, 0x46, 0x96, 0x0d, 0x3f, 0x17, 0x09, 0xc8, 0xec, 0x2c, 0x8f,
+    0x0a, 0x75, 0xc1, 0x2c, 0x39, 0x79, 0x97, 0xa5, 0xad, 0xb8, 0x98, 0xc8, 0xb7, 0xb1, 0x4d, 0x6a,
+    0x1b, 0xc5, 0x78, 0xdc, 0x98, 0x7f, 0xd8, 0xa3, 0x88, 0x9c, 0x0d, 0xbb, 0xcf, 0x8c, 0x88, 0x0f,
+    0x52, 0xe0, 0x02, 0xac, 0x7b, 0x71, 0x35, 0x51, 0x8e, 0xff, 0x3b, 0x84, 0xea, 0x39, 0xb5, 0x55,
+    0x53, 0x43, 0x73, 0xfa, 0x07, 0x52, 0xcb, 0x1f, 0x5c, 0xf4, 0xe5, 0x46, 0xc3,
+};
+
+/* key 00 01 .. 1f, plaintext 255 - i, packetId 0xDEADBEEF, from 0x00000001 */
+static const uint8_t ct256_255[255] = {
+    0x3d, 0xf7, 0xc6, 0xc5, 0xbe, 0xc8, 0x5a, 0x1a, 0xd1, 0x56, 0x35, 0xb4, 0x41, 0xc0, 0x0c, 0x3f,
+    0x2a, 0xa2, 0x66, 0x52, 0x09, 0x0e, 0xca, 0xc6, 0xed, 0xb1, 0xcb, 0x27, 0xce, 0x6f, 0xcd, 0xac,
+    0xb0, 0x49, 0x99, 0x76, 0x26, 0xf2, 0x98, 0xa8, 0xb9, 0xef, 0x9c, 0x47, 0x72, 0xe2, 0xf8, 0x50,
+    0x40, 0xd5, 0xbe, 0x8a, 0xd9, 0x0c, 0xd8, 0xe0, 0x99, 0xe7, 0x41, 0x30, 0xf7, 0x2d, 0x23, 0xab,
+    0xb9, 0x1f, 0x5f, 0x41, 0x9a, 0x7d, 0x9c, 0xa0, 0xec, 0x09, 0x40, 0x65, 0x59, 0x3d, 0x75, 0x44,
+    0x74, 0x54, 0x5c, 0x27, 0xd5, 0x5f, 0x96, 0x44, 0xe5, 0x80, 0x33, 0x5f, 0x5a, 0x13, 0x12, 0xa9,
+    0x8a, 0x38, 0xa6, 0x19, 0x72, 0xfa, 0x4a, 0x57, 0xf8, 0x9f, 0xf0, 0x73, 0x7f, 0x1c, 0xcc, 0x50,
+    0x10, 0x1d, 0xdc, 0xa1, 0x14, 0x31, 0xa7, 0x97, 0x7b, 0x89, 0x33, 0xb3, 0xb6, 0xef, 0xa8, 0xa2,
+    0x57, 0x68, 0x54, 0xd6, 0xf5, 0x09, 0x4f, 0x24, 0xdd, 0x2b, 0xea, 0xca, 0x5f, 0xc1, 0x21, 0x51,
+    0x37, 0xea, 0x0d, 0xdd, 0xb7, 0xf0, 0x7c, 0x58, 0x28, 0x41, 0x6c, 0xf1, 0xe8, 0x35, 0xfb, 0x2e,
+    0xcf, 0x3f, 0x92, 0xc2, 0xed, 0x34, 0x94, 0xe3, 0xe4, 0xc9, 0x79, 0x63, 0xa9, 0x0d, 0x19, 0xd9,
+    0x2c, 0x6e, 0x9a, 0xe4, 0xd7, 0xb8, 0xf0, 0x22, 0xf1, 0x44, 0x93, 0x64, 0xf6, 0x16, 0x46, 0xde,
+    0xe8, 0xbe, 0x51, 0xed, 0xba, 0x03, 0xe6, 0x48, 0x52, 0x25, 0xa8, 0x6c, 0x35, 0x99, 0xf3, 0x8b,
+    0xf8, 0x24, 0xf0, 0xa5, 0x8e, 0x43, 0x59, 0xd0, 0x2b, 0x6e, 0x8d, 0xb7, 0xb5, 0x0c, 0xff, 0xaf,
+    0x4f, 0x56, 0x43, 0x96, 0x75, 0x09, 0x4f, 0x7f, 0x28, 0x4c, 0x9f, 0xe4, 0x33, 0xcd, 0x55, 0x00,
+    0x37, 0x35, 0x58, 0x3e, 0xe9, 0xfe, 0x8e, 0xd9, 0x5a, 0xef, 0x02, 0x30, 0x2c, 0xb9, 0x63,
+};
+
+static uint8_t pt237[237], pt255[255], key256[32];
+
+static void setup(void) {
+    for (unsigned i = 0; i < sizeof(pt237); i++) pt237[i] = (uint8_t)(i * 7u + 3u);
+    for (unsigned i = 0; i < sizeof(pt255); i++) pt255[i] = (uint8_t)(255u - i);
+    for (unsigned i = 0; i < sizeof(key256); i++) key256[i] = (uint8_t)i;
+}
+
+/* Every prefix length (tails of 1..15 bytes included), at an aligned and
+ * an odd address, must give the same bytes as the vector and decrypt back */
+static void check_ctr(const uint8_t *pt, const uint8_t *ct, uint16_t len,
+                      uint32_t packet_id, uint32_t from_node) {
+    static uint8_t buf[256 + 1];
+    for (uint16_t n = 1; n <= len; n++) {
+        for (unsigned off = 0; off < 2; off++) {
+            uint8_t *b = buf + off;
+            memcpy(b, pt, n);
+            aes_ctr_crypt(b, n, packet_id, from_node);
+            if (memcmp(b, ct, n) != 0) {
+                fprintf(stderr, "%s: %u-byte payload at +%u differs\n",
+                        aes_backend_name(), n, off);
+                host_failures++;
+                return;
+            }
+            aes_ctr_crypt(b, n, packet_id, from_node);
+            CHECK(memcmp(b, pt, n) == 0);
+        }
+    }
+}
+
+static void test_kat128(void) {
+    CHECK(aes_set_channel_key(psk128, 16));
+    check_ctr(pt237, ct128_237, sizeof(pt237), 0x12345678u, 0xA1B2C3D4u);
+}
+
+static void test_kat256(void) {
+    CHECK(aes_set_channel_key(key256, 32));
+    check_ctr(pt255, ct256_255, sizeof(pt255), 0xDEADBEEFu, 0x00000001u);
+}
+
+/* Nonce fields each change the keystream; bad keys are refused and keep
+ * the previous one */
+static void test_nonce_and_keys(void) {
+    uint8_t a[32], b[32];
+    CHECK(aes_set_channel_key(psk128, 16));
+    memset(a, 0, sizeof(a));
+    memset(b, 0, sizeof(b));
+    aes_ctr_crypt(a, sizeof(a), 1, 2);
+    aes_ctr_crypt(b, sizeof(b), 2, 2);
+    CHECK(memcmp(a, b, sizeof(a)) != 0);
+    memset(b, 0, sizeof(b));
+    aes_ctr_crypt(b, sizeof(b), 1, 3);
+    CHECK(memcmp(a, b, sizeof(a)) != 0);
+    /* the second block's keystream is not the first one's */
+    CHECK(memcmp(a, a + 16, 16) != 0);
+
+    CHECK(!aes_set_channel_key(key256, 24));
+    CHECK(!aes_set_channel_key(NULL, 16));
+    memset(b, 0, sizeof(b));
+    aes_ctr_crypt(b, sizeof(b), 1, 2);
+    CHECK(memcmp(a, b, sizeof(a)) == 0);
+
+    /* len 0 leaves the buffer alone */
+    b[0] = 0x5A;
+    aes_ctr_crypt(b, 0, 1, 2);
+    CHECK(b[0] == 0x5A);
+}
+
+static void test_backend(void) {
+    CHECK(aes_self_test());
+#ifdef AES_SOFT_NO_AESNI
+    CHECK(!aes_soft_accelerated());
+    CHECK(strcmp(aes_backend_name(), "soft") == 0);
+#else
+    CHECK(strcmp(aes_backend_name(), aes_soft_accelerated() ? "soft+aesni" : "soft") == 0);
+#endif
+    printf("backend: %s\n", aes_backend_name());
+}
+
+int main(void) {
+    setup();
+    test_backend();
+    test_kat128();
+    test_kat256();
+    test_nonce_and_keys();
+    return host_result("test_aes");
+}
@@ -0,0 +1,147 @@
+/**
+ * byte_ring: the size check in init, writes that wrap the buffer end, peek
+ * returning only the contiguous run, consume, and the producer counters
+ * (short and refused writes, high_water at full). Indices are also run past
+ * their 16-bit wrap.
+ */
+
+#include "host_test.h"
+#include "byte_ring.h"
+
+#define SIZE  16u
+
+static uint8_t buf[32768];
+
+static void test_init(void) {
+    byte_ring_t r;
+    CHECK(!byte_ring_init(&r, buf, 0));
+    CHECK(!byte_ring_init(&r, buf, 1));
+    CHECK(!byte_ring_init(&r, buf, 3));
+    CHECK(!byte_ring_init(&r, buf, 24));
+    CHECK(!byte_ring_init(&r, buf, 65535));
+    CHECK(!byte_ring_init(&r, NULL, 16));
+    CHECK(!byte_ring_init(NULL, buf, 16));
+    CHECK(byte_ring_init(&r, buf, 2) && byte_ring_free(&r) == 2);
+    CHECK(byte_ring_init(&r, buf, 32768) && byte_ring_free(&r) == 32768);
+
+    /* the largest ring fills completely */
+    static uint8_t data[32768];
+    CHECK(byte_ring_write(&r, data, 32768) == 32768);
+    CHECK(byte_ring_used(&r) == 32768 && byte_ring_free(&r) == 0);
+    CHECK(r.stats.high_water == 32768);
+}
+
+/* Write across the end: peek gives the run up to the end, then the rest */
+static void test_wrap(void) {
+    byte_ring_t r;
+    uint8_t in[SIZE], junk[SIZE] = {0};
+    const uint8_t *p;
+    for (unsigned i = 0; i < SIZE; i++) in[i] = (uint8_t)(0xA0 + i);
+
+    CHECK(byte_ring_init(&r, buf, SIZE));
+    CHECK(byte_ring_peek(&r, &p) == 0);
+    CHECK(byte_ring_write(&r, junk, 12) == 12);
+    byte_ring_consume(&r, 12);                  /* tail and head at 12 */
+
+    CHECK(byte_ring_write(&r, in, 10) == 10);   /* 4 before the end, 6 after */
+    CHECK(byte_ring_used(&r) == 10);
+    CHECK(byte_ring_peek(&r, &p) == 4 && p == buf + 12);
+    CHECK(memcmp(p, in, 4) == 0);
+    byte_ring_consume(&r, 4);
+    CHECK(byte_ring_peek(&r, &p) == 6 && p == buf);
+    CHECK(memcmp(p, in + 4, 6) == 0);
+
+    /* partial consume: peek continues from the new tail */
+    byte_ring_consume(&r, 2);
+    CHECK(byte_ring_peek(&r, &p) == 4 && memcmp(p, in + 6, 4) == 0);
+
+    /* consume never goes past head */
+    byte_ring_consume(&r, 100);
+    CHECK(byte_ring_used(&r) == 0 && byte_ring_peek(&r, &p) == 0);
+    uint8_t b;
+    CHECK(!byte_ring_get(&r, &b));
+
+    /* byte_ring_get across the end */
+    CHECK(byte_ring_write(&r, in, SIZE) == SIZE);
+    for (unsigned i = 0; i < SIZE; i++) CHECK(byte_ring_get(&r, &b) && b == in[i]);
+    CHECK(!byte_ring_get(&r, &b));
+}
+
+/* Short and refused writes, the fill peak, and bytes in order after all of it */
+static void test_counters(void) {
+    byte_ring_t r;
+    uint8_t in[SIZE * 2];
+    const uint8_t *p;
+    for (unsigned i = 0; i < sizeof(in); i++) in[i] = (uint8_t)i;
+
+    CHECK(byte_ring_init(&r, buf, SIZE));
+    CHECK(byte_ring_write(&r, in, 5) == 5);
+    CHECK(r.stats.written == 5 && r.stats.overflows == 0 && r.stats.high_water == 5);
+
+    CHECK(!byte_ring_write_all(&r, in, 12));    /* 11 free: refused whole */
+    CHECK(byte_ring_used(&r) == 5);
+    CHECK(r.stats.overflows == 1 && r.stats.dropped == 12 && r.stats.written == 5);
+
+    CHECK(byte_ring_write(&r, in + 5, 20) == 11);   /* cut to fit: ring full */
+    CHECK(byte_ring_free(&r) == 0);
+    CHECK(r.stats.overflows == 2 && r.stats.dropped == 12 + 9);
+    CHECK(r.stats.written == 16 && r.stats.high_water == SIZE);
+
+    CHECK(byte_ring_write(&r, in, 1) == 0);     /* full: all of it dropped */
+    CHECK(byte_ring_write_all(&r, in, 0));      /* nothing to write always fits */
+    CHECK(r.stats.overflows == 3 && r.stats.dropped == 22);
+
+    /* what was accepted comes out in order */
+    uint16_t n = byte_ring_peek(&r, &p);
+    CHECK(n == SIZE && memcmp(p, in, SIZE) == 0);
+    byte_ring_consume(&r, n);
+
+    /* the peak is kept after the ring drains */
+    CHECK(byte_ring_write_all(&r, in, 3));
+    CHECK(r.stats.high_water == SIZE && r.stats.written == 19 && r.stats.overflows == 3);
+}
+
+/* Random write/peek/consume against a byte counter; enough traffic to wrap
+ * the free-running 16-bit indices many times */
+static void test_stream(void) {
+    byte_ring_t r;
+    uint8_t chunk[64];
+    uint8_t next_in = 0, next_out = 0;
+    uint32_t in_total = 0, out_total = 0;
+
+    CHECK(byte_ring_init(&r, buf, 64));
+    for (int iter = 0; iter < 200000; iter++) {
+        uint16_t want = (uint16_t)(host_rand() % 40u);
+        for (uint16_t i = 0; i < want; i++) chunk[i] = (uint8_t)(next_in + i);
+        uint16_t n = byte_ring_write(&r, chunk, want);
+        next_in = (uint8_t)(next_in + n);
+        in_total += n;
+
+        const uint8_t *p;
+        uint16_t avail = byte_ring_peek(&r, &p);
+        CHECK(avail <= byte_ring_used(&r) && avail <= 64u - (uint16_t)(p - buf));
+        uint16_t take = avail ? (uint16_t)(host_rand() % (avail + 1u)) : 0;
+        for (uint16_t i = 0; i < take; i++) {
+            if (p[i] != next_out) {
+                fprintf(stderr, "stream: byte %u is %u, expected %u\n",
+                        out_total + i, p[i], next_out);
+                host_failures++;
+                return;
+            }
+            next_out++;
+        }
+        byte_ring_consume(&r, take);
+        out_total += take;
+    }
+    CHECK(in_total == out_total + byte_ring_used(&r));
+    CHECK(r.stats.written == in_total && r.stats.high_water == 64);
+    CHECK(in_total > 3u * 65536u);
+}
+
+int main(void) {
+    test_init();
+    test_wrap();
+    test_counters();
+    test_stream();
+    return host_result("test_byte_ring");
+}
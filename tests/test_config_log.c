@@ -0,0 +1,118 @@
+/**
+ * config_log on the RAM flash emulator: mount of blank and foreign flash,
+ * append/read/remount, page rotation and wear, and power cuts injected at
+ * every point of a save (each remount must give the new record or the last
+ * committed one).
+ */
+
+#include "host_test.h"
+#include "config_flash_ram.h"
+
+#define PAGE_SIZE   2048u       /* STM32WLE5 flash page */
+#define PAGES       4u          /* CONFIG_LOG_PAGES default */
+#define REC_LEN     120u
+
+static uint8_t mem[PAGE_SIZE * PAGES];
+static config_flash_t flash;
+static config_flash_ram_t ram;
+
+/* Record content for save number n */
+static void make_record(uint8_t *rec, uint32_t n) {
+    for (uint32_t i = 0; i < REC_LEN; i++) rec[i] = (uint8_t)(n * 31u + i);
+    memcpy(rec, &n, sizeof(n));
+}
+
+/* Save number held by the latest record, or -1 if none / unexpected */
+static int64_t latest(const config_log_t *log) {
+    uint8_t rec[REC_LEN], want[REC_LEN];
+    if (config_log_read(log, rec, sizeof(rec)) != REC_LEN) return -1;
+    uint32_t n;
+    memcpy(&n, rec, sizeof(n));
+    make_record(want, n);
+    return memcmp(rec, want, REC_LEN) == 0 ? (int64_t)n : -1;
+}
+
+static void test_mount(void) {
+    config_log_t log;
+    uint8_t buf[16];
+
+    config_flash_ram_init(&flash, &ram, mem, PAGE_SIZE, PAGES);
+    CHECK(config_log_mount(&log, &flash));
+    CHECK(config_log_read(&log, buf, sizeof(buf)) == 0);
+
+    /* leftover data from something else mounts as empty */
+    for (uint32_t i = 0; i < sizeof(mem); i++) mem[i] = (uint8_t)host_rand();
+    CHECK(config_log_mount(&log, &flash));
+    CHECK(config_log_read(&log, buf, sizeof(buf)) == 0);
+    CHECK(config_log_append(&log, "abc", 3));
+    CHECK(config_log_mount(&log, &flash));
+    CHECK(config_log_read(&log, buf, sizeof(buf)) == 3 && memcmp(buf, "abc", 3) == 0);
+
+    /* records too long for a page, or for the caller's buffer */
+    uint16_t max = config_log_max_record(&flash);
+    static uint8_t big[PAGE_SIZE];
+    CHECK(!config_log_append(&log, big, (uint16_t)(max + 1)));
+    CHECK(config_log_append(&log, big, max));
+    CHECK(config_log_read(&log, buf, sizeof(buf)) == 0);
+}
+
+/* Each save followed by a remount; erases stay at one per filled page */
+static void test_rotation(void) {
+    config_log_t log;
+    uint8_t rec[REC_LEN];
+    const uint32_t saves = 1000;
+
+    config_flash_ram_init(&flash, &ram, mem, PAGE_SIZE, PAGES);
+    CHECK(config_log_mount(&log, &flash));
+    for (uint32_t n = 1; n <= saves; n++) {
+        make_record(rec, n);
+        CHECK(config_log_append(&log, rec, REC_LEN));
+        CHECK(latest(&log) == n);
+        CHECK(config_log_mount(&log, &flash));
+        CHECK(latest(&log) == n);
+    }
+    uint32_t per_page = (PAGE_SIZE - 8u) / ((8u + REC_LEN + 4u + 7u) & ~7u);
+    CHECK(ram.erases <= saves / per_page + PAGES);
+    printf("rotation: %u saves, %u erases (%u records per page)\n",
+           saves, ram.erases, per_page);
+}
+
+/* Cut power after a random number of programmed doublewords (or before a
+ * page erase), then remount: the new record or the last committed one. */
+static void test_power_cut(void) {
+    config_log_t log;
+    uint8_t rec[REC_LEN];
+    uint32_t committed = 0, cuts = 0;
+    const uint32_t saves = 20000;
+
+    config_flash_ram_init(&flash, &ram, mem, PAGE_SIZE, PAGES);
+    CHECK(config_log_mount(&log, &flash));
+    for (uint32_t n = 1; n <= saves; n++) {
+        make_record(rec, n);
+        ram.cut_after = (int32_t)(host_rand() % 24u);   /* a save is 17 doublewords */
+        bool ok = config_log_append(&log, rec, REC_LEN);
+        if (!ok) cuts++;
+        ram.cut_after = -1;
+
+        CHECK(config_log_mount(&log, &flash));
+        int64_t got = latest(&log);
+        if (got == n) {
+            committed = n;
+        } else if (got != (committed ? (int64_t)committed : -1)) {
+            fprintf(stderr, "save %u (%s): got %lld, last committed %u\n",
+                    n, ok ? "ok" : "cut", (long long)got, committed);
+            host_failures++;
+            return;
+        }
+        CHECK(!ok || committed == n);
+    }
+    CHECK(cuts > 0 && committed > 0);
+    printf("power cut: %u saves, %u cut, %u erases\n", saves, cuts, ram.erases);
+}
+
+int main(void) {
+    test_mount();
+    test_rotation();
+    test_power_cut();
+    return host_result("test_config_log");
+}
@@ -0,0 +1,152 @@
+/**
+ * mesh_data: encode/decode round trip, a corpus of malformed inputs that
+ * must be rejected, and random mutations of a valid frame decoded from
+ * exact-size buffers (run with HOST_SANITIZE=ON to catch stray reads).
+ */
+
+#include "host_test.h"
+#include "mesh_data.h"
+#include <stdlib.h>
+
+typedef struct {
+    const char    *name;
+    const uint8_t *buf;
+    uint16_t       len;
+} corpus_t;
+
+#define ENTRY(n, ...) { n, (const uint8_t[]){ __VA_ARGS__ }, sizeof((const uint8_t[]){ __VA_ARGS__ }) }
+
+static const corpus_t malformed[] = {
+    ENTRY("tag varint cut",          0x88),
+    ENTRY("value varint cut",        0x08, 0x81),
+    ENTRY("varint over 10 bytes",    0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01),
+    ENTRY("field 0",                 0x00, 0x01),
+    ENTRY("payload length past end", 0x12, 0x05, 'a', 'b'),
+    ENTRY("payload length huge",     0x12, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 'a'),
+    ENTRY("payload length cut",      0x12),
+    ENTRY("portnum as len",          0x0A, 0x01, 0x01),
+    ENTRY("payload as varint",       0x10, 0x01),
+    ENTRY("dest as varint",          0x20, 0x01),
+    ENTRY("dest fixed32 cut",        0x25, 0x01, 0x02, 0x03),
+    ENTRY("unknown fixed64 cut",     0x51, 1, 2, 3, 4, 5, 6, 7),
+    ENTRY("unknown fixed32 cut",     0x55, 1, 2),
+    ENTRY("start group",             0x53),
+    ENTRY("end group",               0x54),
+    ENTRY("wire type 6",             0x56, 0x00),
+    ENTRY("wire type 7",             0x57, 0x00),
+    ENTRY("good then cut",           0x08, 0x01, 0x12, 0x02, 'h'),
+};
+
+/* Valid inputs and the view they decode to */
+static void test_valid(void) {
+    mesh_data_t d;
+
+    CHECK(mesh_data_decode(NULL, 0, &d));
+    CHECK(d.portnum == 0 && d.payload == NULL && d.payload_len == 0);
+    CHECK(!mesh_data_decode(NULL, 1, &d));
+    CHECK(!mesh_data_decode((const uint8_t *)"", 0, NULL));
+
+    /* unknown fields of every valid wire type are skipped */
+    static const uint8_t unknown[] = {
+        0x08, 0x01,                                     /* portnum 1 */
+        0x50, 0x96, 0x01,                               /* field 10 varint */
+        0x5A, 0x02, 'x', 'y',                           /* field 11 len */
+        0x61, 1, 2, 3, 4, 5, 6, 7, 8,                   /* field 12 fixed64 */
+        0x6D, 1, 2, 3, 4,                               /* field 13 fixed32 */
+        0x12, 0x02, 'h', 'i',                           /* payload "hi" */
+    };
+    CHECK(mesh_data_decode(unknown, sizeof(unknown), &d));
+    CHECK(d.portnum == 1);
+    CHECK(d.payload == unknown + sizeof(unknown) - 2 && d.payload_len == 2);
+
+    /* a later field replaces an earlier one (proto3 last-wins) */
+    static const uint8_t repeat[] = { 0x08, 0x01, 0x08, 0x43 };
+    CHECK(mesh_data_decode(repeat, sizeof(repeat), &d) && d.portnum == 67);
+}
+
+static void test_round_trip(void) {
+    static const uint8_t text[MESH_DATA_PAYLOAD_MAX] = "hello mesh";
+    mesh_data_t in = {
+        .portnum = MESH_PORTNUM_TEXT_MESSAGE,
+        .payload = text,
+        .payload_len = 200,                     /* with every field set: 235 bytes */
+        .want_response = true,
+        .dest = 0xDEADBEEF,
+        .source = 0x01020304,
+        .request_id = 0xFFFFFFFF,
+        .reply_id = 7,
+        .emoji = 0x1F600,
+        .has_bitfield = true,
+        .bitfield = 0x81,
+    };
+    uint8_t buf[MESH_MAX_FRAME];
+    uint16_t n = mesh_data_encode(&in, buf, sizeof(buf));
+    CHECK(n > 0);
+
+    mesh_data_t out;
+    CHECK(mesh_data_decode(buf, n, &out));
+    CHECK(out.portnum == in.portnum);
+    CHECK(out.payload_len == in.payload_len);
+    CHECK(out.payload && memcmp(out.payload, text, in.payload_len) == 0);
+    CHECK(out.want_response);
+    CHECK(out.dest == in.dest && out.source == in.source);
+    CHECK(out.request_id == in.request_id && out.reply_id == in.reply_id);
+    CHECK(out.emoji == in.emoji);
+    CHECK(out.has_bitfield && out.bitfield == in.bitfield);
+
+    /* too small an output buffer and an oversize payload are refused */
+    CHECK(mesh_data_encode(&in, buf, (uint16_t)(n - 1)) == 0);
+    in.payload_len = MESH_DATA_PAYLOAD_MAX + 1;
+    CHECK(mesh_data_encode(&in, buf, sizeof(buf)) == 0);
+}
+
+/* Each corpus entry, copied to an exact-size heap block */
+static void test_malformed(void) {
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        uint8_t *buf = malloc(malformed[i].len);
+        memcpy(buf, malformed[i].buf, malformed[i].len);
+        mesh_data_t d;
+        if (mesh_data_decode(buf, malformed[i].len, &d)) {
+            fprintf(stderr, "accepted: %s\n", malformed[i].name);
+            host_failures++;
+        }
+        free(buf);
+    }
+}
+
+/* Mutated and truncated copies of a valid frame: whatever is accepted
+ * must leave the payload view inside the input. */
+static void test_mutations(void) {
+    static const uint8_t text[] = "the quick brown fox";
+    mesh_data_t in = {
+        .portnum = MESH_PORTNUM_TEXT_MESSAGE, .payload = text,
+        .payload_len = sizeof(text) - 1, .dest = 0xFFFFFFFF, .request_id = 42,
+        .has_bitfield = true, .bitfield = 1,
+    };
+    uint8_t good[MESH_MAX_FRAME];
+    uint16_t n = mesh_data_encode(&in, good, sizeof(good));
+    CHECK(n > 0);
+
+    for (int iter = 0; iter < 200000; iter++) {
+        uint16_t len = (uint16_t)(host_rand() % (n + 1u));
+        uint8_t *buf = malloc(len ? len : 1);
+        memcpy(buf, good, len);
+        for (uint32_t k = host_rand() % 4u; k > 0 && len; k--)
+            buf[host_rand() % len] = (uint8_t)host_rand();
+
+        mesh_data_t d;
+        if (mesh_data_decode(buf, len, &d) && d.payload_len) {
+            CHECK(d.payload >= buf);
+            CHECK(d.payload + d.payload_len <= buf + len);
+        }
+        free(buf);
+    }
+}
+
+int main(void) {
+    test_valid();
+    test_round_trip();
+    test_malformed();
+    test_mutations();
+    return host_result("test_mesh_data");
+}
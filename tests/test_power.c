@@ -0,0 +1,101 @@
+/**
+ * Power manager on the simulated clock (power_sim): the SLEEP/STOP choice
+ * at its limits, and power_idle driven like the main loop, checking which
+ * sleep ran, when it ended and where the time was booked.
+ */
+
+#include "host_test.h"
+#include "power_sim.h"
+
+static void test_choose(void) {
+    uint32_t ms;
+    CHECK(power_choose(0, false, true, &ms) == POWER_SLEEP && ms == 0);
+    CHECK(power_choose(POWER_STOP_MIN_MS - 1, false, true, &ms) == POWER_SLEEP);
+    CHECK(power_choose(POWER_STOP_MIN_MS, false, true, &ms) == POWER_STOP &&
+          ms == POWER_STOP_MIN_MS);
+    CHECK(power_choose(POWER_STOP_MAX_MS + 1, false, true, &ms) == POWER_STOP &&
+          ms == POWER_STOP_MAX_MS);
+    CHECK(power_choose(POWER_IDLE_FOREVER, false, true, &ms) == POWER_STOP &&
+          ms == POWER_STOP_MAX_MS);
+    CHECK(power_choose(1000, true, true, &ms) == POWER_SLEEP && ms == 0);
+    CHECK(power_choose(1000, false, false, &ms) == POWER_SLEEP && ms == 0);
+}
+
+/* Single sleeps: wake timer, interrupt, wake-up cost, STOP switched off */
+static void test_idle_single(void) {
+    power_stats_t st;
+    power_sim_t *s = power_sim_start();
+
+    s->wake_us = 500;
+    power_idle(10);
+    CHECK(s->stops == 1 && s->now_us == 10500);
+    power_get_stats(&st);
+    CHECK(st.entries[POWER_STOP] == 1 && st.ms[POWER_STOP] == 10);
+
+    /* an interrupt ends STOP before the wake timer */
+    power_sim_irq_in(3000);
+    power_idle(100);
+    CHECK(s->stops == 2 && s->now_us == 10500 + 3000 + 500);
+
+    /* short idle: WFI until the next SysTick */
+    power_sim_run(200);
+    power_idle(POWER_STOP_MIN_MS - 1);
+    CHECK(s->sleeps == 1 && s->now_us == 15000);
+
+    power_set_stop(false);
+    power_idle(POWER_IDLE_FOREVER);
+    CHECK(s->sleeps == 2 && s->stops == 2);
+    power_set_stop(true);
+
+    power_idle(POWER_IDLE_FOREVER);
+    CHECK(s->stops == 3 && s->now_us == 16000 + POWER_STOP_MAX_MS * 1000u + 500);
+}
+
+/* Idle node for 10 s: loop work of 200 us per pass, an LED timer every
+ * 500 ms and one radio packet at 1.2 s. Nearly all of it is STOP. */
+static void test_idle_loop(void) {
+    power_stats_t st;
+    power_sim_t *s = power_sim_start();
+    s->wake_us = 50;
+    power_sim_irq_in(1200000);
+
+    uint32_t led_next = 500;
+    while (s->now_us < 10000000u) {
+        power_sim_run(200);
+        uint32_t now = s->now_us / 1000u;
+        if (now >= led_next) led_next = now + 500;
+        power_idle(led_next > now ? led_next - now : 0);
+    }
+    power_get_stats(&st);
+    uint32_t total = st.ms[POWER_RUN] + st.ms[POWER_SLEEP] + st.ms[POWER_STOP];
+    printf("idle loop: run %u ms, sleep %u ms, stop %u ms (%u entries)\n",
+           st.ms[POWER_RUN], st.ms[POWER_SLEEP], st.ms[POWER_STOP], st.entries[POWER_STOP]);
+    CHECK(total + 3 >= s->now_us / 1000u && total <= s->now_us / 1000u);
+    CHECK(st.ms[POWER_STOP] > total * 95u / 100u);
+    CHECK(st.entries[POWER_STOP] == s->stops && s->stops >= 20 && s->stops <= 23);
+    CHECK(st.entries[POWER_RUN] == s->stops + s->sleeps);
+}
+
+/* While STOP is blocked (UART busy) every idle is a 1 ms WFI */
+static void test_idle_blocked(void) {
+    power_stats_t st;
+    power_sim_t *s = power_sim_start();
+    s->blocked = true;
+
+    for (int i = 0; i < 100; i++) {
+        power_sim_run(100);
+        power_idle(1000);
+    }
+    power_get_stats(&st);
+    CHECK(st.entries[POWER_STOP] == 0 && st.entries[POWER_SLEEP] == 100);
+    CHECK(s->now_us == 100000);
+    CHECK(st.ms[POWER_SLEEP] == 90 && st.ms[POWER_RUN] == 10);
+}
+
+int main(void) {
+    test_choose();
+    test_idle_single();
+    test_idle_loop();
+    test_idle_blocked();
+    return host_result("test_power");
+}
@@ -0,0 +1,147 @@
+/**
+ * radio_lbt driven by scripted busy/free CAD sequences: contention window
+ * growth and cap, the give-up point, backoff bounds for every random input,
+ * and the counters.
+ */
+
+#include "host_test.h"
+#include "radio_lbt.h"
+
+#define SLOT_MS  10u
+
+static void setup(uint8_t max_attempts, uint16_t cw_min, uint16_t cw_max) {
+    radio_lbt_init();
+    radio_lbt_config_t cfg = {
+        .enabled = true, .max_attempts = max_attempts,
+        .cw_min = cw_min, .cw_max = cw_max, .slot_ms = SLOT_MS,
+    };
+    radio_lbt_configure(&cfg);
+}
+
+/* Busy CADs in a row must back off in windows of exactly cw[0..n-1] slots.
+ * rnd = cw - 1 draws the last slot (a smaller window gives less); rnd = cw
+ * draws the first one (a larger window gives more). */
+static void check_windows(const uint16_t *cw, unsigned n) {
+    uint32_t ms;
+    radio_lbt_begin();
+    for (unsigned i = 0; i < n; i++) {
+        CHECK(radio_lbt_on_cad(true, cw[i] - 1u, &ms) == RADIO_LBT_BACKOFF);
+        CHECK(ms == cw[i] * SLOT_MS);
+    }
+    radio_lbt_begin();
+    for (unsigned i = 0; i < n; i++) {
+        CHECK(radio_lbt_on_cad(true, cw[i], &ms) == RADIO_LBT_BACKOFF);
+        CHECK(ms == SLOT_MS);
+    }
+}
+
+static void test_window_doubles(void) {
+    uint32_t ms;
+
+    /* defaults: 4 -> 64 over five backoffs, the sixth busy CAD gives up */
+    setup(RADIO_LBT_MAX_ATTEMPTS, RADIO_LBT_CW_MIN, RADIO_LBT_CW_MAX);
+    static const uint16_t def_cw[] = { 4, 8, 16, 32, 64 };
+    check_windows(def_cw, 5);
+    CHECK(radio_lbt_on_cad(true, 0, &ms) == RADIO_LBT_GIVE_UP);
+
+    /* the window stops at cw_max */
+    setup(10, 4, 16);
+    static const uint16_t capped[] = { 4, 8, 16, 16, 16, 16, 16, 16, 16 };
+    check_windows(capped, 9);
+    CHECK(radio_lbt_on_cad(true, 0, &ms) == RADIO_LBT_GIVE_UP);
+
+    /* a cw_max that is not cw_min * 2^k is still the cap */
+    setup(10, 3, 20);
+    static const uint16_t odd[] = { 3, 6, 12, 20, 20 };
+    check_windows(odd, 5);
+
+    /* a new frame starts again from cw_min */
+    setup(RADIO_LBT_MAX_ATTEMPTS, RADIO_LBT_CW_MIN, RADIO_LBT_CW_MAX);
+    check_windows(def_cw, 3);
+    check_windows(def_cw, 1);
+}
+
+/* Busy, busy, free: two backoffs then CLEAR; busy x6: give up */
+static void test_script(void) {
+    static const struct {
+        const char *script;             /* 'B' busy, 'F' free, one char per CAD */
+        radio_lbt_decision_t last;
+        uint32_t cad_busy, backoffs, give_ups;
+    } cases[] = {
+        { "F",       RADIO_LBT_CLEAR,   0, 0, 0 },
+        { "BBF",     RADIO_LBT_CLEAR,   2, 2, 0 },
+        { "BBBBBF",  RADIO_LBT_CLEAR,   5, 5, 0 },
+        { "BBBBBB",  RADIO_LBT_GIVE_UP, 6, 5, 1 },
+    };
+    for (unsigned c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        setup(RADIO_LBT_MAX_ATTEMPTS, RADIO_LBT_CW_MIN, RADIO_LBT_CW_MAX);
+        radio_lbt_begin();
+        radio_lbt_decision_t d = RADIO_LBT_CLEAR;
+        uint32_t total_ms = 0, runs = 0;
+        for (const char *p = cases[c].script; *p; p++) {
+            uint32_t ms = 0;
+            d = radio_lbt_on_cad(*p == 'B', host_rand(), &ms);
+            runs++;
+            if (d == RADIO_LBT_BACKOFF) total_ms += ms;
+            if (p[1]) CHECK(d == RADIO_LBT_BACKOFF);
+        }
+        CHECK(d == cases[c].last);
+
+        radio_lbt_stats_t st;
+        radio_lbt_get_stats(&st);
+        CHECK(st.cad_runs == runs);
+        CHECK(st.cad_busy == cases[c].cad_busy);
+        CHECK(st.backoffs == cases[c].backoffs);
+        CHECK(st.give_ups == cases[c].give_ups);
+        CHECK(st.backoff_ms == total_ms);
+    }
+
+    /* counters add up across frames until radio_lbt_init */
+    setup(RADIO_LBT_MAX_ATTEMPTS, RADIO_LBT_CW_MIN, RADIO_LBT_CW_MAX);
+    uint32_t ms;
+    for (int f = 0; f < 3; f++) {
+        radio_lbt_begin();
+        (void)radio_lbt_on_cad(true, 0, &ms);
+        (void)radio_lbt_on_cad(false, 0, &ms);
+    }
+    radio_lbt_stats_t st;
+    radio_lbt_get_stats(&st);
+    CHECK(st.cad_runs == 6 && st.cad_busy == 3 && st.backoffs == 3);
+    CHECK(st.backoff_ms == 3 * SLOT_MS);
+}
+
+/* For any random input a backoff is 1..cw slots: never 0, never past cw */
+static void test_backoff_bounds(void) {
+    for (int iter = 0; iter < 20000; iter++) {
+        setup(RADIO_LBT_MAX_ATTEMPTS, RADIO_LBT_CW_MIN, RADIO_LBT_CW_MAX);
+        uint32_t cw = RADIO_LBT_CW_MIN;
+        for (int a = 0; a < RADIO_LBT_MAX_ATTEMPTS - 1; a++) {
+            uint32_t ms = 0;
+            CHECK(radio_lbt_on_cad(true, host_rand(), &ms) == RADIO_LBT_BACKOFF);
+            CHECK(ms >= SLOT_MS && ms <= cw * SLOT_MS && ms % SLOT_MS == 0);
+            cw = cw * 2 > RADIO_LBT_CW_MAX ? RADIO_LBT_CW_MAX : cw * 2;
+        }
+    }
+}
+
+/* Out-of-range settings are clamped by radio_lbt_configure */
+static void test_config_clamp(void) {
+    radio_lbt_config_t cfg = { .enabled = true };
+    radio_lbt_configure(&cfg);
+    radio_lbt_get_config(&cfg);
+    CHECK(cfg.max_attempts == 1 && cfg.cw_min == 1 && cfg.cw_max == 1 && cfg.slot_ms == 1);
+    uint32_t ms;
+    CHECK(radio_lbt_on_cad(true, 0, &ms) == RADIO_LBT_GIVE_UP);
+
+    CHECK(radio_lbt_slot_ms(11, 250000) == 18);     /* 2 x 8.19 ms + 1 */
+    CHECK(radio_lbt_slot_ms(7, 125000) == 4);
+    CHECK(radio_lbt_slot_ms(4, 125000) == 1 && radio_lbt_slot_ms(7, 0) == 1);
+}
+
+int main(void) {
+    test_window_doubles();
+    test_script();
+    test_backoff_bounds();
+    test_config_clamp();
+    return host_result("test_radio_lbt");
+}
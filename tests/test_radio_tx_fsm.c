@@ -0,0 +1,226 @@
+/**
+ * radio_tx_fsm against a fake SubGHz backend: a scripted clock, start calls
+ * that can be made to fail, and counters for every backend call. IRQ events
+ * (CadDone, TxDone, RxTxTimeout) are injected by calling the handlers.
+ */
+
+#include "host_test.h"
+#include "radio_tx_fsm.h"
+
+typedef struct {
+    uint32_t now_ms;
+    uint32_t rnd;
+    bool     cad_ok;            /* start_cad() result */
+    bool     tx_ok;             /* start_tx() result */
+    uint32_t cads;
+    uint32_t txs;
+    uint32_t rx_restarts;
+    uint8_t  tx_frame[255];     /* copy of what start_tx() was given */
+    uint16_t tx_len;
+} fake_radio_t;
+
+static fake_radio_t fake;
+
+static bool fake_start_cad(void) {
+    fake.cads++;
+    return fake.cad_ok;
+}
+
+static bool fake_start_tx(const uint8_t *data, uint16_t len) {
+    fake.txs++;
+    memcpy(fake.tx_frame, data, len);
+    fake.tx_len = len;
+    return fake.tx_ok;
+}
+
+static void fake_restart_rx(void) { fake.rx_restarts++; }
+static uint32_t fake_now_ms(void) { return fake.now_ms; }
+static uint32_t fake_random(void) { return fake.rnd; }
+
+static const radio_tx_backend_t fake_backend = {
+    .start_cad  = fake_start_cad,
+    .start_tx   = fake_start_tx,
+    .restart_rx = fake_restart_rx,
+    .now_ms     = fake_now_ms,
+    .random     = fake_random,
+};
+
+static uint32_t done_calls;
+static radio_tx_result_t done_result;
+
+static void on_tx_done(radio_tx_result_t result) {
+    done_calls++;
+    done_result = result;
+}
+
+static const uint8_t frame[] = { 0xFF, 0xFF, 0xFF, 0xFF, 1, 2, 3, 4, 'h', 'i' };
+
+/* Fresh FSM and backend; LBT on or off */
+static void setup(bool lbt) {
+    memset(&fake, 0, sizeof(fake));
+    fake.now_ms = 1000;
+    fake.cad_ok = true;
+    fake.tx_ok = true;
+    done_calls = 0;
+    radio_lbt_init();
+    radio_lbt_config_t cfg;
+    radio_lbt_get_config(&cfg);
+    cfg.enabled = lbt;
+    cfg.slot_ms = 10;
+    radio_lbt_configure(&cfg);
+    radio_phy_set_tx_done_cb(on_tx_done);
+    radio_tx_fsm_init(&fake_backend);
+}
+
+/* TxDone ends TX, re-arms RX and reports OK once */
+static void test_tx_done(void) {
+    setup(false);
+    uint8_t buf[sizeof(frame)];
+    memcpy(buf, frame, sizeof(buf));
+    CHECK(radio_tx_fsm_start(buf, sizeof(buf)));
+    memset(buf, 0, sizeof(buf));                /* the FSM works on its own copy */
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_TX && radio_tx_fsm_busy());
+    CHECK(fake.txs == 1 && fake.cads == 0);
+    CHECK(fake.tx_len == sizeof(frame) && memcmp(fake.tx_frame, frame, sizeof(frame)) == 0);
+
+    radio_tx_fsm_on_tx_done();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE && !radio_tx_fsm_busy());
+    CHECK(fake.rx_restarts == 1);
+    CHECK(done_calls == 1 && done_result == RADIO_TX_OK);
+
+    /* late or duplicate IRQs in IDLE change nothing */
+    radio_tx_fsm_on_tx_done();
+    radio_tx_fsm_on_timeout();
+    radio_tx_fsm_on_cad_done(false);
+    CHECK(done_calls == 1 && fake.rx_restarts == 1);
+}
+
+/* RxTxTimeout from the radio ends TX as a timeout */
+static void test_timeout_irq(void) {
+    setup(false);
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+    radio_tx_fsm_on_timeout();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE);
+    CHECK(fake.rx_restarts == 1);
+    CHECK(done_calls == 1 && done_result == RADIO_TX_TIMEOUT);
+}
+
+/* No IRQ at all: radio_tx_fsm_poll fires the guard after RADIO_TX_GUARD_MS */
+static void test_guard_poll(void) {
+    setup(false);
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+    fake.now_ms += RADIO_TX_GUARD_MS - 1;
+    radio_tx_fsm_poll();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_TX && done_calls == 0);
+    fake.now_ms += 1;
+    radio_tx_fsm_poll();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE);
+    CHECK(fake.rx_restarts == 1);
+    CHECK(done_calls == 1 && done_result == RADIO_TX_TIMEOUT);
+
+    /* the guard counts from TX entry even across a clock wrap */
+    setup(false);
+    fake.now_ms = 0xFFFFFFFFu - 10u;
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+    fake.now_ms += 100;
+    radio_tx_fsm_poll();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_TX);
+    fake.now_ms += RADIO_TX_GUARD_MS;
+    radio_tx_fsm_poll();
+    CHECK(done_calls == 1 && done_result == RADIO_TX_TIMEOUT);
+}
+
+/* A second frame is refused in every non-IDLE state, and bad frames always */
+static void test_busy_refusal(void) {
+    setup(true);
+    CHECK(!radio_tx_fsm_start(NULL, 4));
+    CHECK(!radio_tx_fsm_start(frame, 0));
+    CHECK(!radio_tx_fsm_start(frame, 256));
+    CHECK(fake.cads == 0 && fake.txs == 0);
+
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_CAD);
+    CHECK(!radio_tx_fsm_start(frame, sizeof(frame)));
+
+    fake.rnd = 0;                               /* one slot */
+    radio_tx_fsm_on_cad_done(true);
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_BACKOFF);
+    CHECK(fake.rx_restarts == 1);               /* listening while backing off */
+    CHECK(!radio_tx_fsm_start(frame, sizeof(frame)));
+
+    fake.now_ms += 9;
+    radio_tx_fsm_poll();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_BACKOFF && fake.cads == 1);
+    fake.now_ms += 1;
+    radio_tx_fsm_poll();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_CAD && fake.cads == 2);
+
+    radio_tx_fsm_on_tx_done();                  /* not in TX: ignored */
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_CAD);
+
+    radio_tx_fsm_on_cad_done(false);
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_TX && fake.txs == 1);
+    CHECK(!radio_tx_fsm_start(frame, sizeof(frame)));
+    radio_tx_fsm_on_tx_done();
+    CHECK(done_calls == 1 && done_result == RADIO_TX_OK);
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+}
+
+/* Backend refuses to start: RX is re-armed and the FSM stays usable */
+static void test_start_failure(void) {
+    setup(false);
+    fake.tx_ok = false;
+    CHECK(!radio_tx_fsm_start(frame, sizeof(frame)));
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE);
+    CHECK(fake.rx_restarts == 1 && done_calls == 0);
+    fake.tx_ok = true;
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+
+    setup(true);
+    fake.cad_ok = false;
+    CHECK(!radio_tx_fsm_start(frame, sizeof(frame)));
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE && fake.rx_restarts == 1);
+
+    /* SetTx refused after a clear CAD: finished as a timeout, RX re-armed */
+    setup(true);
+    fake.tx_ok = false;
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+    radio_tx_fsm_on_cad_done(false);
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE && fake.rx_restarts == 1);
+    CHECK(done_calls == 1 && done_result == RADIO_TX_TIMEOUT);
+
+    /* SetCad refused when a backoff ends */
+    setup(true);
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+    radio_tx_fsm_on_cad_done(true);
+    fake.cad_ok = false;
+    fake.now_ms += 1000;
+    radio_tx_fsm_poll();
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE && fake.rx_restarts == 2);
+    CHECK(done_calls == 1 && done_result == RADIO_TX_TIMEOUT);
+}
+
+/* Channel busy on every CAD: the frame is dropped as CHANNEL_BUSY */
+static void test_give_up(void) {
+    setup(true);
+    CHECK(radio_tx_fsm_start(frame, sizeof(frame)));
+    for (int i = 0; i < RADIO_LBT_MAX_ATTEMPTS; i++) {
+        CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_CAD);
+        radio_tx_fsm_on_cad_done(true);
+        fake.now_ms += 10000;
+        radio_tx_fsm_poll();
+    }
+    CHECK(radio_tx_fsm_state() == RADIO_TX_STATE_IDLE);
+    CHECK(fake.cads == RADIO_LBT_MAX_ATTEMPTS && fake.txs == 0);
+    CHECK(done_calls == 1 && done_result == RADIO_TX_CHANNEL_BUSY);
+}
+
+int main(void) {
+    test_tx_done();
+    test_timeout_irq();
+    test_guard_poll();
+    test_busy_refusal();
+    test_start_failure();
+    test_give_up();
+    return host_result("test_radio_tx_fsm");
+}